@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+// Percentiles of a set of latency samples, in nanoseconds
+struct LatencySummary {
+  uint64_t p50 = 0;
+  uint64_t p90 = 0;
+  uint64_t p99 = 0;
+  uint64_t p999 = 0;
+  uint64_t max = 0;
+};
+
+// Sorts `samples` in place and picks the percentiles out of it
+inline LatencySummary Summarize(std::vector<uint64_t>& samples) {
+  if (samples.empty()) {
+    return {};
+  }
+  std::sort(samples.begin(), samples.end());
+  auto at = [&](double fraction) {
+    return samples[static_cast<size_t>(fraction * static_cast<double>(samples.size() - 1))];
+  };
+  return {at(0.5), at(0.9), at(0.99), at(0.999), samples.back()};
+}
+
+inline void PrintLatencyHeader() {
+  std::cout << std::left << std::setw(40) << "" << std::right;
+  for (auto column : {"p50", "p90", "p99", "p99.9", "max"}) {
+    std::cout << std::setw(10) << column;
+  }
+  std::cout << "   (ns)\n";
+}
+
+inline void PrintLatencyRow(std::string_view name, const LatencySummary& summary) {
+  std::cout << std::left << std::setw(40) << name << std::right;
+  for (auto value : {summary.p50, summary.p90, summary.p99, summary.p999, summary.max}) {
+    std::cout << std::setw(10) << value;
+  }
+  std::cout << "\n";
+}
+
+}  // namespace bench
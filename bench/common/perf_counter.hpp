@@ -0,0 +1,80 @@
+#pragma once
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <optional>
+
+namespace bench {
+
+// Hardware or software event counted for the calling thread with perf_event_open. Counting is
+// often unavailable in containers and VMs (perf_event_paranoid, missing PMU), in which case
+// Read returns std::nullopt and the benchmark still runs.
+class PerfCounter {
+public:
+  PerfCounter(uint32_t type, uint64_t config) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(
+      ::syscall(SYS_perf_event_open, &attr, /* pid */ 0, /* cpu */ -1, /* group */ -1, 0));
+  }
+
+  // Data TLB load misses
+  static PerfCounter DTlbLoadMisses() {
+    return PerfCounter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+  }
+
+  static PerfCounter PageFaults() {
+    return PerfCounter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+  }
+
+  PerfCounter(const PerfCounter&) = delete;
+  PerfCounter& operator=(const PerfCounter&) = delete;
+
+  PerfCounter(PerfCounter&& other) noexcept : fd_(other.fd_) {
+    other.fd_ = -1;
+  }
+
+  ~PerfCounter() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  // Resets the count and starts counting
+  void Start() {
+    if (fd_ >= 0) {
+      ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  void Stop() {
+    if (fd_ >= 0) {
+      ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+
+  std::optional<uint64_t> Read() const {
+    uint64_t count = 0;
+    if (fd_ < 0 || ::read(fd_, &count, sizeof(count)) != sizeof(count)) {
+      return std::nullopt;
+    }
+    return count;
+  }
+
+private:
+  int fd_;
+};
+
+}  // namespace bench
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <thread/util/spin_wait.hpp>
+
+namespace bench {
+
+// CPUs to pin the two sides of a pair to, a negative CPU leaves that side unpinned
+struct CpuPair {
+  int producer = -1;
+  int consumer = -1;
+};
+
+// Pins the calling thread to `cpu`, does nothing for a negative one
+inline void PinToCpu(int cpu) {
+  if (cpu < 0) {
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    std::cerr << "could not pin to cpu " << cpu << "\n";
+  }
+}
+
+// Message of `Bytes` bytes, the first word carries a sequence number
+template <size_t Bytes>
+struct Payload {
+  static_assert(Bytes % sizeof(uint64_t) == 0);
+  std::array<uint64_t, Bytes / sizeof(uint64_t)> words{};
+};
+
+// Runs `producer` and `consumer` on two threads released at the same moment and returns the wall
+// time until both have finished
+template <typename ProducerFn, typename ConsumerFn>
+std::chrono::nanoseconds RunPair(ProducerFn producer, ConsumerFn consumer, CpuPair cpus = {}) {
+  std::atomic<bool> start{false};
+  auto gated = [&start](auto& body, int cpu) {
+    PinToCpu(cpu);
+    while (!start.load(std::memory_order_acquire)) {
+      thread::util::SpinLoopHint();
+    }
+    body();
+  };
+
+  std::thread consumerThread([&] { gated(consumer, cpus.consumer); });
+  std::thread producerThread([&] { gated(producer, cpus.producer); });
+
+  auto begin = std::chrono::steady_clock::now();
+  start.store(true, std::memory_order_release);
+  producerThread.join();
+  consumerThread.join();
+  return std::chrono::steady_clock::now() - begin;
+}
+
+inline double OpsPerSecond(size_t ops, std::chrono::nanoseconds elapsed) {
+  return static_cast<double>(ops) * 1e9 / static_cast<double>(elapsed.count());
+}
+
+inline void PrintRow(std::string_view name, size_t ops, std::chrono::nanoseconds elapsed) {
+  std::cout << std::left << std::setw(40) << name << std::right << std::setw(10)
+            << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms"
+            << std::setw(14) << std::fixed << std::setprecision(2)
+            << OpsPerSecond(ops, elapsed) / 1e6 << " Mops/s\n";
+}
+
+// Number of operations to run, overridable through the first command line argument
+inline size_t OpsFromArgs(int argc, char** argv, size_t fallback) {
+  if (argc > 1) {
+    return std::strtoull(argv[1], nullptr, 10);
+  }
+  return fallback;
+}
+
+// Producer and consumer CPUs from the command line arguments at `first` and `first + 1`, CPUs 0
+// and 1 when they are not given and the machine has two, unpinned otherwise
+inline CpuPair CpusFromArgs(int argc, char** argv, int first) {
+  if (argc > first + 1) {
+    return {std::atoi(argv[first]), std::atoi(argv[first + 1])};
+  }
+  if (std::thread::hardware_concurrency() >= 2) {
+    return {0, 1};
+  }
+  return {};
+}
+
+}  // namespace bench
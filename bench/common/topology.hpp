@@ -0,0 +1,78 @@
+#pragma once
+
+#include <bench/common/spsc_harness.hpp>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// A way of placing the two sides of a pair relative to each other
+struct Placement {
+  std::string name;
+  CpuPair cpus;
+};
+
+namespace detail {
+
+// Integer in /sys/devices/system/cpu/cpu<cpu>/topology/<file>, std::nullopt when the CPU does not
+// exist or is offline
+inline std::optional<int> ReadCpuTopology(int cpu, const std::string& file) {
+  std::ifstream in(std::filesystem::path("/sys/devices/system/cpu/cpu" + std::to_string(cpu)) /
+                   "topology" / file);
+  std::string text;
+  int value = 0;
+  if (!(in >> text) ||
+      std::from_chars(text.data(), text.data() + text.size(), value).ec != std::errc{}) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+}  // namespace detail
+
+// Partners for `base` read from sysfs: the same CPU, its SMT sibling, another core in the same
+// package and a core in another package. Placements the machine does not have are left out, so a
+// single socket box without SMT only reports "same core" and "same socket".
+inline std::vector<Placement> DiscoverPlacements(int base = 0) {
+  std::vector<Placement> placements{{"same core", {base, base}}};
+  const auto basePackage = detail::ReadCpuTopology(base, "physical_package_id");
+  const auto baseCore = detail::ReadCpuTopology(base, "core_id");
+  if (!basePackage || !baseCore) {
+    return placements;
+  }
+
+  std::optional<int> sibling;
+  std::optional<int> sameSocket;
+  std::optional<int> crossSocket;
+  const auto cpus = static_cast<int>(std::thread::hardware_concurrency());
+  for (int cpu = 0; cpu < cpus; ++cpu) {
+    const auto package = detail::ReadCpuTopology(cpu, "physical_package_id");
+    const auto core = detail::ReadCpuTopology(cpu, "core_id");
+    if (cpu == base || !package || !core) {
+      continue;
+    }
+    if (*package != *basePackage) {
+      crossSocket = crossSocket.value_or(cpu);
+    } else if (*core == *baseCore) {
+      sibling = sibling.value_or(cpu);
+    } else {
+      sameSocket = sameSocket.value_or(cpu);
+    }
+  }
+
+  for (auto [name, partner] : {std::pair{"SMT sibling", sibling}, {"same socket", sameSocket},
+                               {"cross socket", crossSocket}}) {
+    if (partner) {
+      placements.push_back({name, {base, *partner}});
+    }
+  }
+  return placements;
+}
+
+}  // namespace bench
@@ -0,0 +1,132 @@
+// SPSC throughput of FastRingBuffer::PushBulk/PopBulk at different batch sizes, against the
+// per-element Push/Pop that publishes an index for every message. The last rows drain the buffer
+// in place with ConsumeAll/ConsumeUpTo behind a per-element Push.
+//
+// Usage: bulk_bench [ops]
+
+#include <bench/common/spsc_harness.hpp>
+#include <common/containers/ring_buffer.hpp>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+
+namespace {
+
+constexpr size_t kCapacity = 4096;
+using Buffer = FastRingBuffer<size_t, CapacityMode::PowerOfTwo>;
+
+void RunPerElement(size_t ops) {
+  Buffer buffer(kCapacity);
+  size_t sink = 0;
+
+  auto elapsed = bench::RunPair(
+    [&] {
+      for (size_t i = 0; i < ops; ++i) {
+        while (!buffer.Push(i)) {
+          thread::util::SpinLoopHint();
+        }
+      }
+    },
+    [&] {
+      for (size_t i = 0; i < ops; ++i) {
+        std::optional<size_t> val;
+        while (!(val = buffer.Pop())) {
+          thread::util::SpinLoopHint();
+        }
+        sink += *val;
+      }
+    });
+
+  if (sink != ops * (ops - 1) / 2) {
+    throw std::runtime_error("Push/Pop lost elements");
+  }
+  bench::PrintRow("Push/Pop", ops, elapsed);
+}
+
+void RunBulk(size_t batch, size_t ops) {
+  Buffer buffer(kCapacity);
+  size_t sink = 0;
+
+  auto elapsed = bench::RunPair(
+    [&] {
+      std::vector<size_t> items(batch);
+      for (size_t next = 0; next < ops;) {
+        const size_t count = std::min(batch, ops - next);
+        std::iota(items.begin(), items.begin() + count, next);
+        for (size_t pushed = 0; pushed < count;) {
+          pushed += buffer.PushBulk(std::span(items.data() + pushed, count - pushed));
+        }
+        next += count;
+      }
+    },
+    [&] {
+      std::vector<size_t> items(batch);
+      for (size_t popped = 0; popped < ops;) {
+        const size_t count = buffer.PopBulk(items.data(), batch);
+        for (size_t i = 0; i < count; ++i) {
+          sink += items[i];
+        }
+        popped += count;
+      }
+    });
+
+  if (sink != ops * (ops - 1) / 2) {
+    throw std::runtime_error("PushBulk/PopBulk lost elements");
+  }
+  bench::PrintRow("PushBulk/PopBulk batch " + std::to_string(batch), ops, elapsed);
+}
+
+// Per-element Push against a consumer that processes elements in place. `max` of 0 uses ConsumeAll.
+void RunConsume(size_t max, size_t ops) {
+  Buffer buffer(kCapacity);
+  size_t sink = 0;
+
+  auto elapsed = bench::RunPair(
+    [&] {
+      for (size_t i = 0; i < ops; ++i) {
+        while (!buffer.Push(i)) {
+          thread::util::SpinLoopHint();
+        }
+      }
+    },
+    [&] {
+      auto add = [&sink](size_t val) { sink += val; };
+      for (size_t consumed = 0; consumed < ops;) {
+        const size_t count = max == 0 ? buffer.ConsumeAll(add) : buffer.ConsumeUpTo(max, add);
+        if (count == 0) {
+          thread::util::SpinLoopHint();
+        }
+        consumed += count;
+      }
+    });
+
+  const auto name = max == 0 ? std::string("Push/ConsumeAll")
+                             : "Push/ConsumeUpTo " + std::to_string(max);
+  if (sink != ops * (ops - 1) / 2) {
+    throw std::runtime_error(name + " lost elements");
+  }
+  bench::PrintRow(name, ops, elapsed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 50'000'000);
+  std::cout << "Capacity: " << kCapacity << ", ops: " << ops << "\n\n";
+
+  RunPerElement(ops);
+  for (size_t batch : {1, 8, 64, 512}) {
+    RunBulk(batch, ops);
+  }
+  for (size_t max : {8, 64}) {
+    RunConsume(max, ops);
+  }
+  RunConsume(0, ops);
+}
@@ -0,0 +1,139 @@
+// Mixed-size message traffic, 16 bytes to 8 KB with mostly small messages: ByteRingBuffer packing
+// records back to back against FastRingBuffer with a worst-case sized slot per message. Both copy
+// only the bytes of each message, the difference is the memory the ring spreads them over.
+//
+// Usage: byte_ring_bench [ops]
+
+#include <array>
+#include <bench/common/spsc_harness.hpp>
+#include <common/containers/byte_ring_buffer.hpp>
+#include <common/containers/ring_buffer.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using common::containers::ByteRingBuffer;
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+
+namespace {
+
+constexpr size_t kMaxMessage = 8192;
+
+struct WorstCaseSlot {
+  uint32_t size;
+  std::array<std::byte, kMaxMessage> data;
+};
+
+// Message sizes with a long tail: ~90% up to 256 bytes, the rest up to 8 KB
+std::vector<uint32_t> MakeSizes(size_t count) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<uint32_t> small(16, 256);
+  std::uniform_int_distribution<uint32_t> large(257, kMaxMessage);
+  std::vector<uint32_t> sizes(count);
+  for (auto& size : sizes) {
+    size = rng() % 10 == 0 ? large(rng) : small(rng);
+  }
+  return sizes;
+}
+
+void Check(const std::string& name, uint64_t expected, uint64_t actual) {
+  if (expected != actual) {
+    throw std::runtime_error(name + " lost bytes");
+  }
+}
+
+void RunByteRing(const std::vector<uint32_t>& sizes, size_t ops, size_t bytes) {
+  ByteRingBuffer buffer(bytes);
+  std::vector<std::byte> source(kMaxMessage, std::byte{1});
+  uint64_t expected = 0;
+  uint64_t received = 0;
+
+  auto elapsed = bench::RunPair(
+    [&] {
+      for (size_t i = 0; i < ops; ++i) {
+        const auto size = sizes[i % sizes.size()];
+        expected += size;
+        std::span<std::byte> region;
+        while ((region = buffer.Reserve(size)).data() == nullptr) {
+        }
+        std::memcpy(region.data(), source.data(), size);
+        buffer.Commit(size);
+      }
+    },
+    [&] {
+      for (size_t i = 0; i < ops;) {
+        auto record = buffer.Peek();
+        if (record.data() != nullptr) {
+          received += record.size();
+          buffer.Release();
+          ++i;
+        }
+      }
+    });
+
+  const std::string name = "ByteRingBuffer " + std::to_string(buffer.Capacity() / 1024) + " KB";
+  Check(name, expected, received);
+  bench::PrintRow(name, ops, elapsed);
+}
+
+void RunWorstCaseSlots(const std::vector<uint32_t>& sizes, size_t ops, size_t slots) {
+  FastRingBuffer<WorstCaseSlot, CapacityMode::PowerOfTwo> buffer(slots);
+  std::vector<std::byte> source(kMaxMessage, std::byte{1});
+  uint64_t expected = 0;
+  uint64_t received = 0;
+
+  auto elapsed = bench::RunPair(
+    [&] {
+      for (size_t i = 0; i < ops; ++i) {
+        const auto size = sizes[i % sizes.size()];
+        expected += size;
+        std::span<WorstCaseSlot> region;
+        while ((region = buffer.Reserve()).empty()) {
+        }
+        region[0].size = size;
+        std::memcpy(region[0].data.data(), source.data(), size);
+        buffer.Commit(1);
+      }
+    },
+    [&] {
+      for (size_t i = 0; i < ops;) {
+        auto items = buffer.Peek();
+        if (!items.empty()) {
+          received += items[0].size;
+          buffer.Release(1);
+          ++i;
+        }
+      }
+    });
+
+  const std::string name = "FastRingBuffer 8 KB slots " +
+                           std::to_string(buffer.Capacity() * sizeof(WorstCaseSlot) / 1024) +
+                           " KB";
+  Check(name, expected, received);
+  bench::PrintRow(name, ops, elapsed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 2'000'000);
+  const auto sizes = MakeSizes(4096);
+  uint64_t total = 0;
+  for (auto size : sizes) {
+    total += size;
+  }
+  std::cout << "Average message size: " << total / sizes.size() << " bytes, ops: " << ops
+            << "\n\n";
+
+  // about as many average sized messages in flight
+  RunByteRing(sizes, ops, 256 * 1024);
+  RunWorstCaseSlots(sizes, ops, 256);
+  // same memory
+  RunWorstCaseSlots(sizes, ops, 32);
+}
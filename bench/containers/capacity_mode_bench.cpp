@@ -0,0 +1,107 @@
+// Compares the `%`-based index arithmetic of the ring buffers with the power-of-two mask mode, and
+// with FixedRingBuffer, whose mask is a compile-time constant and whose slots are inline.
+//
+// Usage: capacity_mode_bench [ops]
+
+#include <bench/common/spsc_harness.hpp>
+#include <common/containers/fixed_ring_buffer.hpp>
+#include <common/containers/ring_buffer.hpp>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+using common::containers::FixedRingBuffer;
+using common::containers::RingBuffer;
+
+namespace {
+
+constexpr size_t kCapacity = 1024;
+
+using FixedBuffer = FixedRingBuffer<size_t, kCapacity>;
+
+// FixedRingBuffer carries its capacity in its type
+template <typename Buffer>
+std::unique_ptr<Buffer> MakeBuffer() {
+  if constexpr (std::is_default_constructible_v<Buffer>) {
+    return std::make_unique<Buffer>();
+  } else {
+    return std::make_unique<Buffer>(kCapacity);
+  }
+}
+
+// Single thread push/pop: isolates the index arithmetic from cache coherence traffic
+template <typename Buffer>
+void RunSingleThread(const std::string& name, size_t ops) {
+  auto owner = MakeBuffer<Buffer>();
+  auto& buffer = *owner;
+  size_t sink = 0;
+
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < ops; ++i) {
+    buffer.Push(i);
+    sink += *buffer.Pop();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+
+  if (sink != ops * (ops - 1) / 2) {
+    throw std::runtime_error(name + " lost elements");
+  }
+  bench::PrintRow(name, ops, elapsed);
+}
+
+template <typename Buffer>
+void RunSpsc(const std::string& name, size_t ops) {
+  auto owner = MakeBuffer<Buffer>();
+  auto& buffer = *owner;
+  size_t sink = 0;
+
+  auto elapsed = bench::RunPair(
+    [&] {
+      for (size_t i = 0; i < ops; ++i) {
+        while (!buffer.Push(i)) {
+          thread::util::SpinLoopHint();
+        }
+      }
+    },
+    [&] {
+      for (size_t i = 0; i < ops; ++i) {
+        std::optional<size_t> val;
+        while (!(val = buffer.Pop())) {
+          thread::util::SpinLoopHint();
+        }
+        sink += *val;
+      }
+    });
+
+  if (sink != ops * (ops - 1) / 2) {
+    throw std::runtime_error(name + " lost elements");
+  }
+  bench::PrintRow(name, ops, elapsed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 10'000'000);
+  std::cout << "Capacity: " << kCapacity << ", ops: " << ops << "\n\n";
+
+  std::cout << "=== Single thread ===\n";
+  RunSingleThread<RingBuffer<size_t, CapacityMode::Modulo>>("RingBuffer modulo", ops);
+  RunSingleThread<RingBuffer<size_t, CapacityMode::PowerOfTwo>>("RingBuffer power-of-two", ops);
+  RunSingleThread<FastRingBuffer<size_t, CapacityMode::Modulo>>("FastRingBuffer modulo", ops);
+  RunSingleThread<FastRingBuffer<size_t, CapacityMode::PowerOfTwo>>("FastRingBuffer power-of-two",
+                                                                    ops);
+  RunSingleThread<FixedBuffer>("FixedRingBuffer", ops);
+
+  std::cout << "\n=== SPSC ===\n";
+  RunSpsc<RingBuffer<size_t, CapacityMode::Modulo>>("RingBuffer modulo", ops);
+  RunSpsc<RingBuffer<size_t, CapacityMode::PowerOfTwo>>("RingBuffer power-of-two", ops);
+  RunSpsc<FastRingBuffer<size_t, CapacityMode::Modulo>>("FastRingBuffer modulo", ops);
+  RunSpsc<FastRingBuffer<size_t, CapacityMode::PowerOfTwo>>("FastRingBuffer power-of-two", ops);
+  RunSpsc<FixedBuffer>("FixedRingBuffer", ops);
+}
@@ -0,0 +1,112 @@
+// SPSC throughput of FastRingBuffer::PushBulk/PopBulk for a 32 B tick: a copy of the tick with a
+// user-provided copy constructor, which takes the element-wise path, against the trivially
+// copyable tick copied with memcpy and with non-temporal stores. The ring holds 16 MB, so the
+// slots are cold by the time the producer comes back to them.
+//
+// Usage: copy_mode_bench [ops] [producer cpu] [consumer cpu]
+
+#include <algorithm>
+#include <bench/common/spsc_harness.hpp>
+#include <common/containers/ring_buffer.hpp>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread/util/spin_wait.hpp>
+#include <type_traits>
+#include <vector>
+
+using common::containers::CapacityMode;
+using common::containers::CopyMode;
+using common::containers::FastRingBuffer;
+
+namespace {
+
+constexpr size_t kRingBytes = 16 << 20;
+
+struct Tick {
+  uint64_t seq;
+  uint64_t time;
+  double price;
+  uint32_t quantity;
+  uint32_t venue;
+};
+
+// Same layout, but not trivially copyable
+struct ElementwiseTick : Tick {
+  ElementwiseTick() = default;
+  ElementwiseTick(const ElementwiseTick& other) : Tick(other) {
+  }
+  ElementwiseTick& operator=(const ElementwiseTick& other) {
+    Tick::operator=(other);
+    return *this;
+  }
+};
+
+static_assert(std::is_trivially_copyable_v<Tick>);
+static_assert(!std::is_trivially_copyable_v<ElementwiseTick>);
+
+template <typename Message>
+void Run(const std::string& name, size_t batch, CopyMode mode, size_t ops, bench::CpuPair cpus) {
+  FastRingBuffer<Message, CapacityMode::PowerOfTwo> buffer(kRingBytes / sizeof(Message),
+                                                           {.prefault = true});
+  uint64_t sum = 0;
+
+  auto elapsed = bench::RunPair(
+    [&] {
+      std::vector<Message> items(batch);
+      for (size_t next = 0; next < ops;) {
+        const size_t count = std::min(batch, ops - next);
+        for (size_t i = 0; i < count; ++i) {
+          items[i].seq = next + i;
+        }
+        for (size_t pushed = 0; pushed < count;) {
+          const size_t n = buffer.PushBulk(
+            std::span<const Message>(items.data() + pushed, count - pushed), mode);
+          if (n == 0) {
+            thread::util::SpinLoopHint();
+          }
+          pushed += n;
+        }
+        next += count;
+      }
+    },
+    [&] {
+      std::vector<Message> items(batch);
+      for (size_t popped = 0; popped < ops;) {
+        const size_t n = buffer.PopBulk(items.data(), batch, mode);
+        for (size_t i = 0; i < n; ++i) {
+          sum += items[i].seq;
+        }
+        if (n == 0) {
+          thread::util::SpinLoopHint();
+        }
+        popped += n;
+      }
+    },
+    cpus);
+
+  const auto row = name + ", batch " + std::to_string(batch);
+  if (sum != ops * (ops - 1) / 2) {
+    throw std::runtime_error(row + " lost elements");
+  }
+  bench::PrintRow(row, ops, elapsed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 50'000'000);
+  const auto cpus = bench::CpusFromArgs(argc, argv, 2);
+  std::cout << "tick: " << sizeof(Tick) << " B, ring: " << (kRingBytes >> 20) << " MB, ops: " << ops
+            << ", producer cpu: " << cpus.producer << ", consumer cpu: " << cpus.consumer
+            << "\n\n";
+
+  for (size_t batch : {16, 256, 4096}) {
+    Run<ElementwiseTick>("element-wise", batch, CopyMode::Cached, ops, cpus);
+    Run<Tick>("memcpy", batch, CopyMode::Cached, ops, cpus);
+    Run<Tick>("non-temporal", batch, CopyMode::NonTemporal, ops, cpus);
+    std::cout << "\n";
+  }
+}
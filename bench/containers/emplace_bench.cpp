@@ -0,0 +1,83 @@
+// Producer-side cost of Push(T) against in-place Emplace/TryEmplace for a large message type with
+// a non-trivial move constructor. The consumer drains with Peek/Release so that only the moves
+// made on the way into the ring are counted.
+//
+// Usage: emplace_bench [ops]
+
+#include <array>
+#include <bench/common/spsc_harness.hpp>
+#include <chrono>
+#include <common/containers/ring_buffer.hpp>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+
+namespace {
+
+constexpr size_t kCapacity = 1024;
+
+struct Order {
+  inline static size_t moves = 0;
+
+  Order(uint64_t id, std::string_view venue) : id(id), venue(venue) {
+    payload.fill(id);
+  }
+
+  Order(Order&& other) noexcept
+    : id(other.id), venue(std::move(other.venue)), payload(other.payload) {
+    ++moves;
+  }
+
+  uint64_t id;
+  std::string venue;
+  std::array<uint64_t, 36> payload;
+};
+
+using Buffer = FastRingBuffer<Order, CapacityMode::PowerOfTwo>;
+
+template <typename PushFn>
+void Run(const std::string& name, size_t ops, PushFn push) {
+  Buffer buffer(kCapacity);
+  Order::moves = 0;
+  uint64_t sink = 0;
+
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < ops;) {
+    for (; i < ops && push(buffer, i); ++i) {
+    }
+    for (auto items = buffer.Peek(kCapacity); !items.empty(); items = buffer.Peek(kCapacity)) {
+      for (const auto& order : items) {
+        sink += order.payload.back();
+      }
+      buffer.Release(items.size());
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+
+  if (sink != ops * (ops - 1) / 2) {
+    throw std::runtime_error(name + " lost elements");
+  }
+  bench::PrintRow(name, ops, elapsed);
+  std::cout << "  moves per push: " << static_cast<double>(Order::moves) / ops << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 10'000'000);
+  std::cout << "Message size: " << sizeof(Order) << " bytes, capacity: " << kCapacity
+            << ", ops: " << ops << "\n\n";
+
+  Run("Push(Order(...))", ops,
+      [](Buffer& buffer, uint64_t id) { return buffer.Push(Order(id, "XNAS")); });
+  Run("Emplace(...)", ops, [](Buffer& buffer, uint64_t id) { return buffer.Emplace(id, "XNAS"); });
+  Run("TryEmplace(factory)", ops, [](Buffer& buffer, uint64_t id) {
+    return buffer.TryEmplace([id] { return Order(id, "XNAS"); });
+  });
+}
@@ -0,0 +1,69 @@
+// FastForwardQueue, whose slots say whether they are full, against FastRingBuffer with its cached
+// indices, on a pinned producer/consumer core pair. Batch size 1 is plain FastForward, larger
+// batches are B-Queue style lookahead probing.
+//
+// Usage: fast_forward_bench [ops] [producer cpu] [consumer cpu]
+
+#include <bench/common/spsc_harness.hpp>
+#include <common/containers/fast_forward_queue.hpp>
+#include <common/containers/ring_buffer.hpp>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread/util/spin_wait.hpp>
+
+using common::containers::CapacityMode;
+using common::containers::FastForwardQueue;
+using common::containers::FastRingBuffer;
+
+namespace {
+
+constexpr size_t kCapacity = 1024;
+
+template <typename Queue>
+void Run(const std::string& name, Queue& queue, size_t ops, bench::CpuPair cpus) {
+  uint64_t sum = 0;
+  auto elapsed = bench::RunPair(
+    [&] {
+      for (uint64_t i = 0; i < ops; ++i) {
+        while (!queue.Push(i)) {
+          thread::util::SpinLoopHint();
+        }
+      }
+    },
+    [&] {
+      for (size_t i = 0; i < ops;) {
+        if (auto val = queue.Pop()) {
+          sum += *val;
+          ++i;
+        } else {
+          thread::util::SpinLoopHint();
+        }
+      }
+    },
+    cpus);
+
+  if (sum != ops * (ops - 1) / 2) {
+    throw std::runtime_error(name + " lost elements");
+  }
+  bench::PrintRow(name, ops, elapsed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 100'000'000);
+  const auto cpus = bench::CpusFromArgs(argc, argv, 2);
+  std::cout << "capacity: " << kCapacity << ", ops: " << ops << ", producer cpu: " << cpus.producer
+            << ", consumer cpu: " << cpus.consumer << "\n\n";
+
+  {
+    FastRingBuffer<uint64_t, CapacityMode::PowerOfTwo> buffer(kCapacity);
+    Run("FastRingBuffer", buffer, ops, cpus);
+  }
+  for (size_t batch : {1, 8, 32, 128}) {
+    FastForwardQueue<uint64_t> queue(kCapacity, batch);
+    Run("FastForwardQueue batch " + std::to_string(batch), queue, ops, cpus);
+  }
+}
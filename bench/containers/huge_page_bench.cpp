@@ -0,0 +1,105 @@
+// Regular against huge page backed slots for a 1M-entry FastRingBuffer of cache-line sized
+// messages. The ring is filled and drained in bursts much larger than the TLB reach of 4 KB pages,
+// with dTLB load misses and page faults counted over the run. The counters need perf_event_open,
+// they print as n/a where it is not permitted.
+//
+// Usage: huge_page_bench [ops]
+
+#include <bench/common/perf_counter.hpp>
+#include <bench/common/spsc_harness.hpp>
+#include <chrono>
+#include <common/containers/ring_buffer.hpp>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+using common::containers::StorageOptions;
+using os::memory::PageBacking;
+
+namespace {
+
+constexpr size_t kCapacity = 1 << 20;
+// 16 MB of messages per burst
+constexpr size_t kBurst = 1 << 18;
+
+struct Message {
+  uint64_t seq;
+  uint64_t payload[7];
+};
+
+using Buffer = FastRingBuffer<Message, CapacityMode::PowerOfTwo>;
+
+const char* ToString(PageBacking backing) {
+  switch (backing) {
+    case PageBacking::Regular:
+      return "regular pages";
+    case PageBacking::Transparent:
+      return "transparent huge pages";
+    case PageBacking::HugeTlb:
+      return "hugetlb pages";
+  }
+  return "unknown";
+}
+
+std::string PerOp(std::optional<uint64_t> count, size_t ops) {
+  if (!count) {
+    return "n/a";
+  }
+  return std::to_string(static_cast<double>(*count) / static_cast<double>(ops));
+}
+
+void Run(const std::string& name, size_t ops, StorageOptions options) {
+  auto constructBegin = std::chrono::steady_clock::now();
+  Buffer buffer(kCapacity, options);
+  auto constructElapsed = std::chrono::steady_clock::now() - constructBegin;
+
+  auto tlbMisses = bench::PerfCounter::DTlbLoadMisses();
+  auto pageFaults = bench::PerfCounter::PageFaults();
+  uint64_t sum = 0;
+
+  tlbMisses.Start();
+  pageFaults.Start();
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t produced = 0, consumed = 0; consumed < ops;) {
+    for (size_t i = 0; i < kBurst && produced < ops; ++i, ++produced) {
+      buffer.Emplace(Message{produced, {}});
+    }
+    for (auto items = buffer.Peek(kBurst); !items.empty(); items = buffer.Peek(kBurst)) {
+      for (const auto& message : items) {
+        sum += message.seq;
+      }
+      consumed += items.size();
+      buffer.Release(items.size());
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+  tlbMisses.Stop();
+  pageFaults.Stop();
+
+  if (sum != ops * (ops - 1) / 2) {
+    throw std::runtime_error(name + " lost messages");
+  }
+  bench::PrintRow(name, ops, elapsed);
+  std::cout << "  backed by " << ToString(buffer.Backing()) << ", constructed in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(constructElapsed).count()
+            << " ms\n"
+            << "  dTLB load misses per op: " << PerOp(tlbMisses.Read(), ops)
+            << ", page faults per op: " << PerOp(pageFaults.Read(), ops) << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 50'000'000);
+  std::cout << "Message size: " << sizeof(Message) << " bytes, capacity: " << kCapacity
+            << ", burst: " << kBurst << ", ops: " << ops << "\n\n";
+
+  Run("regular pages", ops, {});
+  Run("regular pages, prefaulted", ops, {.prefault = true});
+  Run("huge pages", ops, {.hugePages = true});
+  Run("huge pages, prefaulted", ops, {.hugePages = true, .prefault = true});
+}
@@ -0,0 +1,157 @@
+// Persisting a stream of 64 B messages for replay: a FastRingBuffer without persistence, a
+// FastRingBuffer drained by a thread that write()s the messages to a file, and a
+// JournalRingBuffer synced every 1 ms and 10 ms from a third thread. Ends with the time Open takes
+// to recover a full 64 MB journal. The journal files go to `dir`, so pick one on the disk that
+// matters: on tmpfs msync is nearly free.
+//
+// Usage: journal_bench [ops] [dir]
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <bench/common/spsc_harness.hpp>
+#include <chrono>
+#include <common/containers/journal_ring_buffer.hpp>
+#include <common/containers/ring_buffer.hpp>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <thread/util/spin_wait.hpp>
+#include <vector>
+
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+using common::containers::JournalRingBuffer;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr size_t kCapacity = 1 << 20;
+constexpr size_t kWriteBatch = 1024;
+
+using Message = bench::Payload<64>;
+
+template <typename Buffer>
+std::chrono::nanoseconds RunThrough(Buffer& buffer, size_t ops, uint64_t& sum,
+                                    std::vector<Message>* written = nullptr, int fd = -1) {
+  return bench::RunPair(
+    [&] {
+      Message msg;
+      for (uint64_t i = 0; i < ops; ++i) {
+        msg.words[0] = i;
+        while (!buffer.Push(msg)) {
+          thread::util::SpinLoopHint();
+        }
+      }
+    },
+    [&] {
+      for (size_t i = 0; i < ops;) {
+        if (auto msg = buffer.Pop()) {
+          sum += msg->words[0];
+          ++i;
+          if (written != nullptr) {
+            written->push_back(*msg);
+            if (written->size() == kWriteBatch || i == ops) {
+              const auto bytes = static_cast<ssize_t>(written->size() * sizeof(Message));
+              if (::write(fd, written->data(), bytes) != bytes) {
+                throw std::runtime_error("write failed");
+              }
+              written->clear();
+            }
+          }
+        } else {
+          thread::util::SpinLoopHint();
+        }
+      }
+    });
+}
+
+void Check(const std::string& name, size_t ops, uint64_t sum, std::chrono::nanoseconds elapsed) {
+  if (sum != ops * (ops - 1) / 2) {
+    throw std::runtime_error(name + " lost elements");
+  }
+  bench::PrintRow(name, ops, elapsed);
+}
+
+void RunFastRingBuffer(size_t ops) {
+  FastRingBuffer<Message, CapacityMode::PowerOfTwo> buffer(kCapacity);
+  uint64_t sum = 0;
+  auto elapsed = RunThrough(buffer, ops, sum);
+  Check("FastRingBuffer, not persisted", ops, sum, elapsed);
+}
+
+void RunWriteThread(size_t ops, const std::string& path) {
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("cannot open " + path);
+  }
+  FastRingBuffer<Message, CapacityMode::PowerOfTwo> buffer(kCapacity);
+  std::vector<Message> written;
+  written.reserve(kWriteBatch);
+  uint64_t sum = 0;
+  auto elapsed = RunThrough(buffer, ops, sum, &written, fd);
+  ::close(fd);
+  std::filesystem::remove(path);
+  Check("FastRingBuffer + write() thread", ops, sum, elapsed);
+}
+
+void RunJournal(size_t ops, const std::string& path, std::chrono::milliseconds interval) {
+  std::filesystem::remove(path);
+  auto journal = JournalRingBuffer<Message>::Create(path.c_str(), kCapacity);
+  std::atomic<bool> done{false};
+  size_t syncs = 0;
+  std::thread syncer([&] {
+    while (!done.load(std::memory_order_relaxed)) {
+      std::this_thread::sleep_for(interval);
+      journal.Sync();
+      ++syncs;
+    }
+  });
+
+  uint64_t sum = 0;
+  auto elapsed = RunThrough(journal, ops, sum);
+  done.store(true, std::memory_order_relaxed);
+  syncer.join();
+  std::filesystem::remove(path);
+  Check("Journal, Sync every " + std::to_string(interval.count()) + " ms (" +
+          std::to_string(syncs) + " syncs)",
+        ops, sum, elapsed);
+}
+
+void RunReopen(const std::string& path) {
+  std::filesystem::remove(path);
+  {
+    auto journal = JournalRingBuffer<Message>::Create(path.c_str(), kCapacity);
+    Message msg;
+    while (journal.Push(msg)) {
+    }
+    journal.Sync();
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  auto journal = JournalRingBuffer<Message>::Open(path.c_str());
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+  std::cout << "\nOpen of a full " << (kCapacity * sizeof(Message) >> 20) << " MB journal: "
+            << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() << " us, "
+            << journal.WriteSequence() - journal.ReadSequence() << " messages to replay\n";
+  std::filesystem::remove(path);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 20'000'000);
+  const std::string dir = argc > 2 ? argv[2] : std::filesystem::temp_directory_path().string();
+  const std::string path = dir + "/journal_bench_" + std::to_string(::getpid());
+  std::cout << "message: " << sizeof(Message) << " B, capacity: " << kCapacity << ", ops: " << ops
+            << ", dir: " << dir << "\n\n";
+
+  RunFastRingBuffer(ops);
+  RunWriteThread(ops, path);
+  RunJournal(ops, path, 10ms);
+  RunJournal(ops, path, 1ms);
+  RunReopen(path);
+}
@@ -0,0 +1,70 @@
+// FastRingBuffer with lazy index publication: each side makes its index visible every `batch`
+// elements instead of on every Push and Pop, on a pinned producer/consumer core pair. Batch 1 is
+// the default eager publication.
+//
+// Usage: lazy_publish_bench [ops] [producer cpu] [consumer cpu]
+
+#include <bench/common/spsc_harness.hpp>
+#include <common/containers/ring_buffer.hpp>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread/util/spin_wait.hpp>
+
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+using common::containers::PublishOptions;
+
+namespace {
+
+constexpr size_t kCapacity = 1024;
+
+void Run(size_t ops, PublishOptions publish, bench::CpuPair cpus) {
+  FastRingBuffer<uint64_t, CapacityMode::PowerOfTwo> buffer(kCapacity, {}, publish);
+
+  uint64_t sum = 0;
+  auto elapsed = bench::RunPair(
+    [&] {
+      for (uint64_t i = 0; i < ops; ++i) {
+        while (!buffer.Push(i)) {
+          thread::util::SpinLoopHint();
+        }
+      }
+      buffer.Flush();
+    },
+    [&] {
+      for (size_t i = 0; i < ops;) {
+        if (auto val = buffer.Pop()) {
+          sum += *val;
+          ++i;
+        } else {
+          thread::util::SpinLoopHint();
+        }
+      }
+    },
+    cpus);
+
+  const auto name = "producer batch " + std::to_string(publish.producerBatch) +
+                    ", consumer batch " + std::to_string(publish.consumerBatch);
+  if (sum != ops * (ops - 1) / 2) {
+    throw std::runtime_error(name + " lost elements");
+  }
+  bench::PrintRow(name, ops, elapsed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 100'000'000);
+  const auto cpus = bench::CpusFromArgs(argc, argv, 2);
+  std::cout << "capacity: " << kCapacity << ", ops: " << ops << ", producer cpu: " << cpus.producer
+            << ", consumer cpu: " << cpus.consumer << "\n\n";
+
+  for (size_t batch : {1, 8, 32, 128}) {
+    Run(ops, {.producerBatch = batch, .consumerBatch = batch}, cpus);
+  }
+  // one side batched at a time
+  Run(ops, {.producerBatch = 32, .consumerBatch = 1}, cpus);
+  Run(ops, {.producerBatch = 1, .consumerBatch = 32}, cpus);
+}
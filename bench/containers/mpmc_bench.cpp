@@ -0,0 +1,123 @@
+// MPMCQueue against a std::deque guarded by thread::sync::Mutex, with the same number of producer
+// and consumer threads.
+//
+// Usage: mpmc_bench [ops]
+
+#include <atomic>
+#include <bench/common/spsc_harness.hpp>
+#include <chrono>
+#include <common/containers/mpmc_queue.hpp>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <thread/sync/mutex.hpp>
+#include <vector>
+
+using common::containers::MPMCQueue;
+
+namespace {
+
+constexpr size_t kCapacity = 4096;
+
+// The status quo: a bounded deque behind a mutex
+class MutexQueue {
+public:
+  explicit MutexQueue(size_t capacity) : capacity_(capacity) {
+  }
+
+  bool Push(size_t val) {
+    std::lock_guard guard(mutex_);
+    if (data_.size() == capacity_) {
+      return false;
+    }
+    data_.push_back(val);
+    return true;
+  }
+
+  std::optional<size_t> Pop() {
+    std::lock_guard guard(mutex_);
+    if (data_.empty()) {
+      return std::nullopt;
+    }
+    auto val = data_.front();
+    data_.pop_front();
+    return val;
+  }
+
+private:
+  thread::sync::Mutex mutex_;
+  std::deque<size_t> data_;
+  size_t capacity_;
+};
+
+template <typename Queue>
+void Run(const std::string& name, size_t threadsPerSide, size_t ops) {
+  Queue queue(kCapacity);
+  const size_t perProducer = ops / threadsPerSide;
+  const size_t total = perProducer * threadsPerSide;
+  std::atomic<bool> start{false};
+  std::atomic<size_t> consumed{0};
+  std::atomic<size_t> sink{0};
+
+  auto waitForStart = [&] {
+    while (!start.load(std::memory_order_acquire)) {
+      thread::util::SpinLoopHint();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < threadsPerSide; ++t) {
+    threads.emplace_back([&] {
+      waitForStart();
+      for (size_t i = 0; i < perProducer; ++i) {
+        while (!queue.Push(i)) {
+          thread::util::SpinLoopHint();
+        }
+      }
+    });
+    threads.emplace_back([&] {
+      waitForStart();
+      size_t local = 0;
+      while (consumed.load(std::memory_order_relaxed) < total) {
+        if (auto val = queue.Pop()) {
+          local += *val;
+          consumed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          thread::util::SpinLoopHint();
+        }
+      }
+      sink.fetch_add(local);
+    });
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  start.store(true, std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+
+  if (sink.load() != threadsPerSide * (perProducer * (perProducer - 1) / 2)) {
+    throw std::runtime_error(name + " lost elements");
+  }
+  bench::PrintRow(name + " " + std::to_string(threadsPerSide) + "P/" +
+                    std::to_string(threadsPerSide) + "C",
+                  total, elapsed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 10'000'000);
+  std::cout << "Capacity: " << kCapacity << ", ops: " << ops
+            << ", hardware threads: " << std::thread::hardware_concurrency() << "\n\n";
+
+  for (size_t threads : {1, 2, 4, 8, 16}) {
+    Run<MPMCQueue<size_t>>("MPMCQueue", threads, ops);
+    Run<MutexQueue>("Mutex + std::deque", threads, ops);
+  }
+}
@@ -0,0 +1,101 @@
+// Contention scaling of MPSCRingBuffer from 1 to 64 producers, against a FastRingBuffer whose
+// producer side is serialized with a TTASSpinLock.
+//
+// Usage: mpsc_bench [ops]
+
+#include <atomic>
+#include <bench/common/spsc_harness.hpp>
+#include <chrono>
+#include <common/containers/mpsc_ring_buffer.hpp>
+#include <common/containers/ring_buffer.hpp>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <thread/sync/ttas_spinlock.hpp>
+#include <vector>
+
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+using common::containers::MPSCRingBuffer;
+
+namespace {
+
+constexpr size_t kCapacity = 4096;
+
+class LockedFastRingBuffer {
+public:
+  explicit LockedFastRingBuffer(size_t capacity) : buffer_(capacity) {
+  }
+
+  bool Push(size_t val) {
+    std::lock_guard guard(lock_);
+    return buffer_.Push(val);
+  }
+
+  std::optional<size_t> Pop() {
+    return buffer_.Pop();
+  }
+
+private:
+  thread::sync::TASSpinLock lock_;
+  FastRingBuffer<size_t, CapacityMode::PowerOfTwo> buffer_;
+};
+
+template <typename Buffer>
+void Run(const std::string& name, size_t producers, size_t ops) {
+  Buffer buffer(kCapacity);
+  const size_t perProducer = ops / producers;
+  const size_t total = perProducer * producers;
+  std::atomic<bool> start{false};
+  size_t sink = 0;
+
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&] {
+      while (!start.load(std::memory_order_acquire)) {
+        thread::util::SpinLoopHint();
+      }
+      for (size_t i = 0; i < perProducer; ++i) {
+        while (!buffer.Push(i)) {
+          thread::util::SpinLoopHint();
+        }
+      }
+    });
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  start.store(true, std::memory_order_release);
+  for (size_t consumed = 0; consumed < total;) {
+    if (auto val = buffer.Pop()) {
+      sink += *val;
+      ++consumed;
+    } else {
+      thread::util::SpinLoopHint();
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (sink != producers * (perProducer * (perProducer - 1) / 2)) {
+    throw std::runtime_error(name + " lost elements");
+  }
+  bench::PrintRow(name + " x" + std::to_string(producers), total, elapsed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 10'000'000);
+  std::cout << "Capacity: " << kCapacity << ", ops: " << ops
+            << ", hardware threads: " << std::thread::hardware_concurrency() << "\n\n";
+
+  for (size_t producers : {1, 2, 4, 8, 16, 32, 64}) {
+    Run<MPSCRingBuffer<size_t>>("MPSCRingBuffer", producers, ops);
+    Run<LockedFastRingBuffer>("TTASSpinLock + FastRingBuffer", producers, ops);
+  }
+}
@@ -0,0 +1,111 @@
+// Producer throughput of the lossy OverwritingRingBuffer against FastRingBuffer, whose producer
+// has to wait for room, with a consumer that keeps up and with one that spends extra time on every
+// element. The lossy rows also report how many entries the consumer skipped.
+//
+// Usage: overwriting_bench [ops] [producer cpu] [consumer cpu]
+
+#include <array>
+#include <atomic>
+#include <bench/common/spsc_harness.hpp>
+#include <chrono>
+#include <common/containers/overwriting_ring_buffer.hpp>
+#include <common/containers/ring_buffer.hpp>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread/util/spin_wait.hpp>
+
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+using common::containers::OverwritingRingBuffer;
+
+namespace {
+
+constexpr size_t kCapacity = 1024;
+using Tick = std::array<uint64_t, 4>;
+
+// Stands in for the consumer's processing of an element
+void Work(size_t spins) {
+  for (size_t i = 0; i < spins; ++i) {
+    thread::util::SpinLoopHint();
+  }
+}
+
+void RunBlocking(size_t ops, size_t workSpins, bench::CpuPair cpus) {
+  FastRingBuffer<Tick, CapacityMode::PowerOfTwo> buffer(kCapacity);
+  std::chrono::nanoseconds producerTime{};
+
+  bench::RunPair(
+    [&] {
+      auto begin = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < ops; ++i) {
+        while (!buffer.Push({i, i, i, i})) {
+          thread::util::SpinLoopHint();
+        }
+      }
+      producerTime = std::chrono::steady_clock::now() - begin;
+    },
+    [&] {
+      for (size_t i = 0; i < ops;) {
+        if (buffer.Pop()) {
+          Work(workSpins);
+          ++i;
+        } else {
+          thread::util::SpinLoopHint();
+        }
+      }
+    },
+    cpus);
+
+  bench::PrintRow("FastRingBuffer, work " + std::to_string(workSpins), ops, producerTime);
+}
+
+void RunOverwriting(size_t ops, size_t workSpins, bench::CpuPair cpus) {
+  OverwritingRingBuffer<Tick> buffer(kCapacity);
+  std::atomic<bool> done{false};
+  std::chrono::nanoseconds producerTime{};
+  uint64_t consumed = 0;
+
+  bench::RunPair(
+    [&] {
+      auto begin = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < ops; ++i) {
+        buffer.Push({i, i, i, i});
+      }
+      producerTime = std::chrono::steady_clock::now() - begin;
+      done.store(true, std::memory_order_release);
+    },
+    [&] {
+      while (true) {
+        // checked before popping, so the last entries are drained after the producer stops
+        const bool last = done.load(std::memory_order_acquire);
+        if (buffer.Pop()) {
+          Work(workSpins);
+          ++consumed;
+        } else if (last) {
+          break;
+        } else {
+          thread::util::SpinLoopHint();
+        }
+      }
+    },
+    cpus);
+
+  bench::PrintRow("OverwritingRingBuffer, work " + std::to_string(workSpins), ops, producerTime);
+  std::cout << "  consumed: " << consumed << ", skipped: " << buffer.Skipped() << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 20'000'000);
+  const auto cpus = bench::CpusFromArgs(argc, argv, 2);
+  std::cout << "capacity: " << kCapacity << ", ops: " << ops << ", producer cpu: " << cpus.producer
+            << ", consumer cpu: " << cpus.consumer << "\n";
+  std::cout << "rates are producer side\n\n";
+
+  for (size_t workSpins : {0, 50}) {
+    RunBlocking(ops, workSpins, cpus);
+    RunOverwriting(ops, workSpins, cpus);
+  }
+}
@@ -0,0 +1,78 @@
+// FastRingBuffer SPSC throughput with software prefetching of upcoming slots at several distances,
+// for 256 B and 1 KB messages in a 64 MB ring, far larger than L2. The producer fills every word
+// of a message and the consumer reads every word, so both sides touch each line of each slot.
+// Distance 0 leaves everything to the hardware prefetcher.
+//
+// Usage: prefetch_bench [ops] [producer cpu] [consumer cpu]
+
+#include <bench/common/spsc_harness.hpp>
+#include <common/containers/ring_buffer.hpp>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread/util/spin_wait.hpp>
+
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+using common::containers::PrefetchOptions;
+
+namespace {
+
+constexpr size_t kRingBytes = 64 << 20;
+
+template <size_t Bytes>
+void Run(size_t distance, size_t ops, bench::CpuPair cpus) {
+  using Message = bench::Payload<Bytes>;
+  FastRingBuffer<Message, CapacityMode::PowerOfTwo> buffer(
+    kRingBytes / Bytes, {.prefault = true}, {},
+    PrefetchOptions{.consumerDistance = distance, .producerDistance = distance});
+
+  uint64_t sum = 0;
+  auto elapsed = bench::RunPair(
+    [&] {
+      Message message;
+      for (uint64_t i = 0; i < ops; ++i) {
+        message.words.fill(i);
+        while (!buffer.Push(message)) {
+          thread::util::SpinLoopHint();
+        }
+      }
+    },
+    [&] {
+      for (size_t i = 0; i < ops;) {
+        if (auto message = buffer.Pop()) {
+          sum += std::accumulate(message->words.begin(), message->words.end(), uint64_t{0});
+          ++i;
+        } else {
+          thread::util::SpinLoopHint();
+        }
+      }
+    },
+    cpus);
+
+  const auto name = std::to_string(Bytes) + " B, distance " + std::to_string(distance);
+  if (sum != ops * (ops - 1) / 2 * (Bytes / sizeof(uint64_t))) {
+    throw std::runtime_error(name + " lost elements");
+  }
+  bench::PrintRow(name, ops, elapsed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 5'000'000);
+  const auto cpus = bench::CpusFromArgs(argc, argv, 2);
+  std::cout << "ring: " << (kRingBytes >> 20) << " MB, ops: " << ops
+            << ", producer cpu: " << cpus.producer << ", consumer cpu: " << cpus.consumer
+            << "\n\n";
+
+  for (size_t distance : {0, 1, 2, 4, 8, 16}) {
+    Run<256>(distance, ops, cpus);
+  }
+  std::cout << "\n";
+  for (size_t distance : {0, 1, 2, 4, 8, 16}) {
+    Run<1024>(distance, ops, cpus);
+  }
+}
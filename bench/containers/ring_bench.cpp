@@ -0,0 +1,164 @@
+// RingBuffer and FastRingBuffer SPSC throughput and ping-pong round trip latency, with the two
+// threads placed on the same core, SMT siblings, two cores of a socket and two sockets, as far as
+// the machine has them. Throughput sweeps capacity and payload size, latency sweeps payload size
+// over a pair of small rings, one per direction.
+//
+// Usage: ring_bench [ops] [round trips] [base cpu]
+
+#include <bench/common/latency.hpp>
+#include <bench/common/spsc_harness.hpp>
+#include <bench/common/topology.hpp>
+#include <chrono>
+#include <common/containers/ring_buffer.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <thread/util/spin_wait.hpp>
+#include <vector>
+
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+using common::containers::RingBuffer;
+
+namespace {
+
+constexpr size_t kLatencyCapacity = 64;
+constexpr size_t kWarmupRoundTrips = 1000;
+
+// Busy-waits, but gives the CPU up after a while: with both threads on the same core a pure spin
+// would hold it until the end of the time slice
+class Waiter {
+public:
+  void Wait() {
+    if (++spins_ < kSpinsBeforeYield) {
+      thread::util::SpinLoopHint();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  void Reset() {
+    spins_ = 0;
+  }
+
+private:
+  static constexpr size_t kSpinsBeforeYield = 128;
+  size_t spins_{0};
+};
+
+template <typename Buffer, typename T>
+void PushWaiting(Buffer& buffer, const T& val) {
+  Waiter waiter;
+  while (!buffer.Push(val)) {
+    waiter.Wait();
+  }
+}
+
+template <typename Buffer>
+auto PopWaiting(Buffer& buffer) {
+  Waiter waiter;
+  while (true) {
+    if (auto val = buffer.Pop()) {
+      return *val;
+    }
+    waiter.Wait();
+  }
+}
+
+template <template <typename, CapacityMode> class Ring, size_t Bytes>
+void RunThroughput(const std::string& name, size_t capacity, size_t ops, bench::CpuPair cpus) {
+  using Buffer = Ring<bench::Payload<Bytes>, CapacityMode::PowerOfTwo>;
+  Buffer buffer(capacity);
+
+  uint64_t sum = 0;
+  auto elapsed = bench::RunPair(
+    [&] {
+      bench::Payload<Bytes> payload;
+      for (uint64_t i = 0; i < ops; ++i) {
+        payload.words[0] = i;
+        PushWaiting(buffer, payload);
+      }
+    },
+    [&] {
+      for (size_t i = 0; i < ops; ++i) {
+        sum += PopWaiting(buffer).words[0];
+      }
+    },
+    cpus);
+
+  const auto row = name + " cap " + std::to_string(capacity) + " " + std::to_string(Bytes) + "B";
+  if (sum != ops * (ops - 1) / 2) {
+    throw std::runtime_error(row + " lost elements");
+  }
+  bench::PrintRow(row, ops, elapsed);
+}
+
+template <template <typename, CapacityMode> class Ring, size_t Bytes>
+void RunLatency(const std::string& name, size_t roundTrips, bench::CpuPair cpus) {
+  using Buffer = Ring<bench::Payload<Bytes>, CapacityMode::PowerOfTwo>;
+  Buffer ping(kLatencyCapacity);
+  Buffer pong(kLatencyCapacity);
+
+  std::vector<uint64_t> samples;
+  samples.reserve(roundTrips);
+  bool reordered = false;
+  bench::RunPair(
+    [&] {
+      bench::Payload<Bytes> payload;
+      for (size_t i = 0; i < kWarmupRoundTrips + roundTrips; ++i) {
+        payload.words[0] = i;
+        auto begin = std::chrono::steady_clock::now();
+        PushWaiting(ping, payload);
+        reordered |= PopWaiting(pong).words[0] != i;
+        auto elapsed = std::chrono::steady_clock::now() - begin;
+        if (i >= kWarmupRoundTrips) {
+          samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+      }
+    },
+    [&] {
+      for (size_t i = 0; i < kWarmupRoundTrips + roundTrips; ++i) {
+        PushWaiting(pong, PopWaiting(ping));
+      }
+    },
+    cpus);
+
+  if (reordered) {
+    throw std::runtime_error(name + " reordered a round trip");
+  }
+  bench::PrintLatencyRow(name + " " + std::to_string(Bytes) + "B", bench::Summarize(samples));
+}
+
+template <template <typename, CapacityMode> class Ring>
+void RunSuite(const std::string& name, size_t ops, size_t roundTrips, bench::CpuPair cpus) {
+  for (size_t capacity : {64, 1024, 65536}) {
+    RunThroughput<Ring, 8>(name, capacity, ops, cpus);
+    RunThroughput<Ring, 64>(name, capacity, ops, cpus);
+    RunThroughput<Ring, 256>(name, capacity, ops, cpus);
+  }
+  std::cout << "\n";
+  bench::PrintLatencyHeader();
+  RunLatency<Ring, 8>(name + " round trip", roundTrips, cpus);
+  RunLatency<Ring, 64>(name + " round trip", roundTrips, cpus);
+  RunLatency<Ring, 256>(name + " round trip", roundTrips, cpus);
+  std::cout << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 10'000'000);
+  const size_t roundTrips = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+  const int base = argc > 3 ? std::atoi(argv[3]) : 0;
+  std::cout << "ops: " << ops << ", round trips: " << roundTrips << "\n";
+
+  for (const auto& placement : bench::DiscoverPlacements(base)) {
+    std::cout << "\n== " << placement.name << ": cpu " << placement.cpus.producer << " -> cpu "
+              << placement.cpus.consumer << " ==\n\n";
+    RunSuite<RingBuffer>("RingBuffer", ops, roundTrips, placement.cpus);
+    RunSuite<FastRingBuffer>("FastRingBuffer", ops, roundTrips, placement.cpus);
+  }
+}
@@ -0,0 +1,114 @@
+// Cross-process message passing: ShmRingBuffer against a Unix domain socket pair. The producer is
+// a forked child, the parent consumes and checks that nothing was lost.
+//
+// Usage: shm_bench [ops]
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <bench/common/spsc_harness.hpp>
+#include <chrono>
+#include <common/containers/shm_ring_buffer.hpp>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using common::containers::ShmRingBuffer;
+
+namespace {
+
+constexpr size_t kCapacity = 4096;
+
+struct Message {
+  uint64_t seq;
+  uint64_t payload[7];
+};
+
+// Runs `producer` in a forked child while the parent runs `consumer`, returns the parent's wall
+// time until both have finished
+template <typename ProducerFn, typename ConsumerFn>
+std::chrono::nanoseconds RunProcesses(ProducerFn producer, ConsumerFn consumer) {
+  auto begin = std::chrono::steady_clock::now();
+  pid_t pid = ::fork();
+  if (pid < 0) {
+    throw std::runtime_error("fork failed");
+  }
+  if (pid == 0) {
+    producer();
+    ::_exit(0);
+  }
+  consumer();
+  int status = 0;
+  ::waitpid(pid, &status, 0);
+  return std::chrono::steady_clock::now() - begin;
+}
+
+void Check(const std::string& name, uint64_t sum, size_t ops) {
+  if (sum != ops * (ops - 1) / 2) {
+    throw std::runtime_error(name + " lost messages");
+  }
+}
+
+void RunShm(const std::string& name, size_t ops, size_t spinBudget) {
+  auto ring = ShmRingBuffer<Message>::Create(kCapacity);
+  uint64_t sum = 0;
+
+  auto elapsed = RunProcesses(
+    [&] {
+      auto producer = ShmRingBuffer<Message>::Open(ring.Fd());
+      for (uint64_t i = 0; i < ops; ++i) {
+        producer.WaitPush(Message{i, {}}, spinBudget);
+      }
+    },
+    [&] {
+      for (size_t i = 0; i < ops; ++i) {
+        sum += ring.WaitPop(spinBudget).seq;
+      }
+    });
+
+  Check(name, sum, ops);
+  bench::PrintRow(name, ops, elapsed);
+}
+
+void RunSocket(size_t ops) {
+  int fds[2];
+  if (::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0) {
+    throw std::runtime_error("socketpair failed");
+  }
+  uint64_t sum = 0;
+
+  auto elapsed = RunProcesses(
+    [&] {
+      for (uint64_t i = 0; i < ops; ++i) {
+        Message msg{i, {}};
+        if (::send(fds[0], &msg, sizeof(msg), 0) != sizeof(msg)) {
+          ::_exit(1);
+        }
+      }
+    },
+    [&] {
+      Message msg;
+      for (size_t i = 0; i < ops && ::recv(fds[1], &msg, sizeof(msg), 0) == sizeof(msg); ++i) {
+        sum += msg.seq;
+      }
+    });
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+  Check("socketpair", sum, ops);
+  bench::PrintRow("socketpair(SOCK_SEQPACKET)", ops, elapsed);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 5'000'000);
+  std::cout << "Message size: " << sizeof(Message) << " bytes, capacity: " << kCapacity
+            << ", ops: " << ops << "\n\n";
+
+  RunShm("ShmRingBuffer spin then park", ops, common::containers::kDefaultSpinBudget);
+  RunShm("ShmRingBuffer park immediately", ops, 0);
+  RunSocket(ops);
+}
@@ -0,0 +1,108 @@
+// Latest-value publication of a 2 KB snapshot from one thread to another: TripleBuffer against a
+// copy in and out under thread::sync::Mutex. The writer publishes as fast as it can while the
+// reader keeps reading the newest snapshot. Rates are publications per second, the reader's count
+// of fresh snapshots is printed below each row.
+//
+// Usage: triple_buffer_bench [ops] [writer cpu] [reader cpu]
+
+#include <array>
+#include <atomic>
+#include <bench/common/spsc_harness.hpp>
+#include <chrono>
+#include <common/containers/triple_buffer.hpp>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread/sync/mutex.hpp>
+
+using common::containers::TripleBuffer;
+
+namespace {
+
+using Snapshot = std::array<uint64_t, 256>;
+
+class MutexSnapshot {
+public:
+  void Write(const Snapshot& snapshot) {
+    std::lock_guard guard(mutex_);
+    snapshot_ = snapshot;
+  }
+
+  void Read(Snapshot& out) {
+    std::lock_guard guard(mutex_);
+    out = snapshot_;
+  }
+
+private:
+  thread::sync::Mutex mutex_;
+  Snapshot snapshot_{};
+};
+
+// `write(seq)` publishes a snapshot filled with `seq`, `read()` returns the newest snapshot
+template <typename WriteFn, typename ReadFn>
+void Run(const std::string& name, size_t ops, bench::CpuPair cpus, WriteFn write, ReadFn read) {
+  std::atomic<bool> done{false};
+  uint64_t fresh = 0;
+  bool torn = false;
+
+  auto elapsed = bench::RunPair(
+    [&] {
+      for (uint64_t seq = 1; seq <= ops; ++seq) {
+        write(seq);
+      }
+      done.store(true, std::memory_order_release);
+    },
+    [&] {
+      uint64_t last = 0;
+      while (!done.load(std::memory_order_acquire)) {
+        const Snapshot& snapshot = read();
+        torn |= snapshot.front() != snapshot.back();
+        fresh += snapshot.front() != last;
+        last = snapshot.front();
+      }
+    },
+    cpus);
+
+  if (torn) {
+    throw std::runtime_error(name + " returned a torn snapshot");
+  }
+  bench::PrintRow(name, ops, elapsed);
+  std::cout << "  fresh snapshots read: " << fresh << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 5'000'000);
+  const auto cpus = bench::CpusFromArgs(argc, argv, 2);
+  std::cout << "snapshot: " << sizeof(Snapshot) << " B, ops: " << ops
+            << ", writer cpu: " << cpus.producer << ", reader cpu: " << cpus.consumer << "\n\n";
+
+  {
+    TripleBuffer<Snapshot> buffer;
+    Run(
+      "TripleBuffer", ops, cpus,
+      [&](uint64_t seq) {
+        buffer.Back().fill(seq);
+        buffer.Publish();
+      },
+      [&]() -> const Snapshot& { return buffer.Read(); });
+  }
+  {
+    MutexSnapshot shared;
+    Snapshot local{};
+    Snapshot copy{};
+    Run(
+      "Mutex + copy", ops, cpus,
+      [&](uint64_t seq) {
+        local.fill(seq);
+        shared.Write(local);
+      },
+      [&]() -> const Snapshot& {
+        shared.Read(copy);
+        return copy;
+      });
+  }
+}
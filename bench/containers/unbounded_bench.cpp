@@ -0,0 +1,102 @@
+// SPSC throughput of UnboundedSPSCQueue against a bounded FastRingBuffer, at several segment
+// sizes. The last rows push a burst ahead of the consumer, which makes the unbounded queue grow
+// and then give its segments back.
+//
+// Usage: unbounded_bench [ops]
+
+#include <bench/common/spsc_harness.hpp>
+#include <chrono>
+#include <common/containers/ring_buffer.hpp>
+#include <common/containers/unbounded_spsc_queue.hpp>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread/util/spin_wait.hpp>
+
+using common::containers::CapacityMode;
+using common::containers::FastRingBuffer;
+using common::containers::UnboundedSPSCQueue;
+
+namespace {
+
+template <typename PushFn, typename PopFn>
+void Run(const std::string& name, size_t ops, PushFn push, PopFn pop) {
+  uint64_t sum = 0;
+  auto elapsed = bench::RunPair(
+    [&] {
+      for (uint64_t i = 0; i < ops; ++i) {
+        push(i);
+      }
+    },
+    [&] {
+      for (size_t i = 0; i < ops;) {
+        if (auto val = pop()) {
+          sum += *val;
+          ++i;
+        } else {
+          thread::util::SpinLoopHint();
+        }
+      }
+    });
+
+  if (sum != ops * (ops - 1) / 2) {
+    throw std::runtime_error(name + " lost elements");
+  }
+  bench::PrintRow(name, ops, elapsed);
+}
+
+void RunBounded(size_t ops) {
+  FastRingBuffer<uint64_t, CapacityMode::PowerOfTwo> buffer(1024);
+  Run(
+    "FastRingBuffer(1024)", ops,
+    [&](uint64_t val) {
+      while (!buffer.Push(val)) {
+        thread::util::SpinLoopHint();
+      }
+    },
+    [&] { return buffer.Pop(); });
+}
+
+void RunUnbounded(size_t ops, size_t segmentSize) {
+  UnboundedSPSCQueue<uint64_t> queue(segmentSize);
+  Run(
+    "UnboundedSPSCQueue segment " + std::to_string(segmentSize), ops,
+    [&](uint64_t val) { queue.Push(val); }, [&] { return queue.Pop(); });
+  std::cout << "  segments left: " << queue.Segments() << "\n";
+}
+
+void RunBurst(size_t ops, size_t segmentSize) {
+  UnboundedSPSCQueue<uint64_t> queue(segmentSize);
+  auto begin = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < ops; ++i) {
+    queue.Push(i);
+  }
+  auto const peak = queue.Segments();
+  uint64_t sum = 0;
+  while (auto val = queue.Pop()) {
+    sum += *val;
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+
+  if (sum != ops * (ops - 1) / 2) {
+    throw std::runtime_error("burst lost elements");
+  }
+  bench::PrintRow("burst, segment " + std::to_string(segmentSize), ops, elapsed);
+  std::cout << "  segments at peak: " << peak << ", after draining: " << queue.Segments() << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t ops = bench::OpsFromArgs(argc, argv, 20'000'000);
+  std::cout << "ops: " << ops << "\n\n";
+
+  RunBounded(ops);
+  for (size_t segmentSize : {256, 1024, 8192}) {
+    RunUnbounded(ops, segmentSize);
+  }
+  for (size_t segmentSize : {1024, 8192}) {
+    RunBurst(ops, segmentSize);
+  }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace common::containers {
+
+// How the bulk operations copy trivially copyable elements
+enum class CopyMode {
+  // memcpy through the cache, the right choice unless the batch is large and cold
+  Cached,
+  // Non-temporal stores that write around the cache, so a large batch does not evict the working
+  // set of the copying thread. The reader of the destination then takes it from memory. Falls
+  // back to memcpy where the CPU has no such stores.
+  NonTemporal,
+};
+
+namespace detail {
+
+// Copies `bytes` from `src` to `dst`, which must not overlap, with non-temporal stores. Ends with
+// a store fence: non-temporal stores are weakly ordered, and a release store of an index that
+// follows would not keep them ahead of it on its own.
+inline void CopyNonTemporal(void* dst, const void* src, size_t bytes) {
+#if defined(__SSE2__)
+  constexpr size_t kVector = sizeof(__m128i);
+  auto* out = static_cast<char*>(dst);
+  auto const* in = static_cast<const char*>(src);
+
+  // streaming stores need an aligned destination, the source may be anywhere
+  const size_t head = (kVector - reinterpret_cast<uintptr_t>(out) % kVector) % kVector;
+  if (bytes < head + kVector) {
+    std::memcpy(out, in, bytes);
+    return;
+  }
+  std::memcpy(out, in, head);
+  out += head;
+  in += head;
+  bytes -= head;
+
+  for (; bytes >= 4 * kVector; bytes -= 4 * kVector, out += 4 * kVector, in += 4 * kVector) {
+    auto const* from = reinterpret_cast<const __m128i*>(in);
+    auto* to = reinterpret_cast<__m128i*>(out);
+    _mm_stream_si128(to, _mm_loadu_si128(from));
+    _mm_stream_si128(to + 1, _mm_loadu_si128(from + 1));
+    _mm_stream_si128(to + 2, _mm_loadu_si128(from + 2));
+    _mm_stream_si128(to + 3, _mm_loadu_si128(from + 3));
+  }
+  for (; bytes >= kVector; bytes -= kVector, out += kVector, in += kVector) {
+    _mm_stream_si128(reinterpret_cast<__m128i*>(out),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+  }
+  std::memcpy(out, in, bytes);
+  _mm_sfence();
+#else
+  std::memcpy(dst, src, bytes);
+#endif
+}
+
+// Destinations a run of T can be copied to with a single memcpy
+template <typename It, typename T>
+concept ContiguousOutputOf = std::contiguous_iterator<It> && std::same_as<std::iter_value_t<It>, T>;
+
+// Copies `count` trivially copyable elements into raw or live storage at `dst`
+template <typename T>
+void CopyElements(T* dst, const T* src, size_t count, CopyMode mode) {
+  if (mode == CopyMode::NonTemporal) {
+    CopyNonTemporal(dst, src, count * sizeof(T));
+  } else {
+    std::memcpy(dst, src, count * sizeof(T));
+  }
+}
+
+}  // namespace detail
+
+}  // namespace common::containers
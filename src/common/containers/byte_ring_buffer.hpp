@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <common/containers/slot_storage.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <os/constants.hpp>
+#include <span>
+
+namespace common::containers {
+
+// Single Producer Single Consumer ring of variable-length byte records, in the spirit of a bip
+// buffer.
+//
+// Records are packed back to back, each behind a small length prefix, so mixed-size traffic only
+// takes the memory it actually needs instead of a worst-case slot per message. A record is always
+// contiguous: when it does not fit before the end of the storage, the producer marks the rest of
+// the lap as padding and writes the record at the start. Both sides keep a cached copy of the
+// other side's index, like FastRingBuffer.
+//
+// Capacity is in bytes and rounded up to a power of two. Payloads start on an 8-byte boundary.
+class ByteRingBuffer {
+  using Header = uint32_t;
+
+  static constexpr size_t kRecordAlignment = 8;
+  static constexpr size_t kHeaderSize = kRecordAlignment;
+  // header of the unused space at the end of a lap that a wrapped record skipped
+  static constexpr Header kPadding = UINT32_MAX;
+
+public:
+  explicit ByteRingBuffer(size_t capacity, StorageOptions options = {})
+    : mask_(std::bit_ceil(std::max(capacity, 4 * kHeaderSize)) - 1), data_(mask_ + 1, options) {
+  }
+
+  // Returns `size` contiguous bytes to serialize a record into, empty when there is not enough
+  // room. Sizes above MaxRecordSize() never fit.
+  std::span<std::byte> Reserve(size_t size) {
+    if (size > MaxRecordSize()) {
+      return {};
+    }
+    // can use relaxed due to Modification Ordering guarantee
+    auto const writeIdx = writeIdx_.load(std::memory_order_relaxed);
+    const size_t total = RecordSize(size);
+    const size_t tail = Capacity() - Offset(writeIdx);
+    // a record that does not fit before the end also needs the rest of the lap
+    const size_t needed = total <= tail ? total : tail + total;
+    if (Capacity() - (writeIdx - readIdxCached_) < needed) {
+      readIdxCached_ = readIdx_.load(std::memory_order_acquire);
+      if (Capacity() - (writeIdx - readIdxCached_) < needed) {
+        return {};
+      }
+    }
+
+    reservedIdx_ = writeIdx + (needed - total);
+    return {data_.Data() + Offset(reservedIdx_) + kHeaderSize, size};
+  }
+
+  // Publishes the record returned by the last Reserve, keeping its first `size` bytes. `size` may
+  // be less than what was reserved, for serializers that only know an upper bound up front.
+  void Commit(size_t size) {
+    auto const writeIdx = writeIdx_.load(std::memory_order_relaxed);
+    if (reservedIdx_ != writeIdx) {
+      WriteHeader(writeIdx, kPadding);
+    }
+    WriteHeader(reservedIdx_, static_cast<Header>(size));
+    writeIdx_.store(reservedIdx_ + RecordSize(size), std::memory_order_release);
+  }
+
+  // Copies `record` into the ring. Returns false when there is not enough room.
+  bool Push(std::span<const std::byte> record) {
+    auto region = Reserve(record.size());
+    if (region.data() == nullptr) {
+      return false;
+    }
+    std::memcpy(region.data(), record.data(), record.size());
+    Commit(record.size());
+    return true;
+  }
+
+  // Returns the payload of the oldest record, which stays in the ring until Release. Empty when
+  // there is no record. Zero-length records are returned as an empty span with a non-null data().
+  std::span<const std::byte> Peek() {
+    // can use relaxed due to Modification Ordering guarantee
+    auto readIdx = readIdx_.load(std::memory_order_relaxed);
+    if (readIdx == writeIdxCached_) {
+      writeIdxCached_ = writeIdx_.load(std::memory_order_acquire);
+      if (readIdx == writeIdxCached_) {
+        return {};
+      }
+    }
+
+    auto size = ReadHeader(readIdx);
+    if (size == kPadding) {
+      // the wrapped record was published together with the padding in front of it
+      readIdx += Capacity() - Offset(readIdx);
+      size = ReadHeader(readIdx);
+    }
+    releaseIdx_ = readIdx + RecordSize(size);
+    return {data_.Data() + Offset(readIdx) + kHeaderSize, size};
+  }
+
+  // Hands the space of the record returned by the last Peek back to the producer
+  void Release() {
+    readIdx_.store(releaseIdx_, std::memory_order_release);
+  }
+
+  // Largest payload Reserve can ever succeed for. A record has to be contiguous, so a record of
+  // up to half the storage always fits once the ring has drained, wherever the indices stand.
+  size_t MaxRecordSize() const {
+    return std::min<size_t>(Capacity() / 2 - kHeaderSize, kPadding - 1);
+  }
+
+  // Size of the storage in bytes, including record headers and padding
+  size_t Capacity() const {
+    return mask_ + 1;
+  }
+
+private:
+  static size_t RecordSize(size_t size) {
+    return kHeaderSize + (size + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+  }
+
+  size_t Offset(size_t idx) const {
+    return idx & mask_;
+  }
+
+  void WriteHeader(size_t idx, Header header) {
+    std::memcpy(data_.Data() + Offset(idx), &header, sizeof(header));
+  }
+
+  Header ReadHeader(size_t idx) const {
+    Header header;
+    std::memcpy(&header, data_.Data() + Offset(idx), sizeof(header));
+    return header;
+  }
+
+  // read-only after construction, shared by both sides
+  alignas(os::kL1CacheLineSize) size_t mask_;
+  detail::SlotStorage<std::byte> data_;
+  // free-running byte indices, records and padding are always a multiple of kRecordAlignment
+  alignas(os::kL1CacheLineSize) std::atomic<size_t> readIdx_{0};
+  alignas(os::kL1CacheLineSize) size_t writeIdxCached_{0};
+  size_t releaseIdx_{0};
+  alignas(os::kL1CacheLineSize) std::atomic<size_t> writeIdx_{0};
+  alignas(os::kL1CacheLineSize) size_t readIdxCached_{0};
+  size_t reservedIdx_{0};
+};
+
+}  // namespace common::containers
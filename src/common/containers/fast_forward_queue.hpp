@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <common/containers/slot_storage.hpp>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <os/constants.hpp>
+#include <utility>
+
+namespace common::containers {
+
+// Single Producer Single Consumer queue without shared indices, after FastForward and B-Queue.
+//
+// Every slot carries a flag that says whether it holds an element, so the producer and the
+// consumer never read each other's position, only the slots themselves. Checking the flag of every
+// slot would make both sides fight over the same lines whenever they are close, so each side
+// probes the slot `batchSize` ahead instead: once it is free (or full for the consumer), all slots
+// up to it are too, and the side works through that batch without touching the other side's
+// lines. When the probe fails the batch is halved until a single slot, so a queue with little
+// traffic still moves elements one by one.
+//
+// Capacity is rounded up to a power of two.
+template <typename T>
+class FastForwardQueue {
+  struct Slot {
+    std::atomic<bool> full{false};
+    alignas(T) std::byte storage[sizeof(T)];
+
+    T* Get() {
+      return std::launder(reinterpret_cast<T*>(storage));
+    }
+  };
+
+public:
+  explicit FastForwardQueue(size_t capacity, size_t batchSize = 32, StorageOptions options = {})
+    : mask_(std::bit_ceil(capacity) - 1),
+      batchSize_(std::clamp<size_t>(batchSize, 1, mask_ + 1)),
+      slots_(mask_ + 1, options) {
+    for (size_t i = 0; i <= mask_; ++i) {
+      slots_.Construct(i);
+    }
+  }
+
+  ~FastForwardQueue() {
+    // full slots are contiguous from the consumer's position
+    for (size_t idx = tail_; slots_[idx & mask_].full.load(std::memory_order_relaxed); ++idx) {
+      std::destroy_at(slots_[idx & mask_].Get());
+      slots_[idx & mask_].full.store(false, std::memory_order_relaxed);
+    }
+    slots_.Destroy(0, mask_ + 1);
+  }
+
+  bool Push(T val) {
+    return Emplace(std::move(val));
+  }
+
+  // Constructs the element directly in its slot. Returns false without constructing anything when
+  // the slot under the producer is still full.
+  template <typename... Args>
+  bool Emplace(Args&&... args) {
+    if (head_ == batchHead_ && !ProbeFree()) {
+      return false;
+    }
+
+    auto& slot = slots_[head_ & mask_];
+    std::construct_at(slot.Get(), std::forward<Args>(args)...);
+    slot.full.store(true, std::memory_order_release);
+    ++head_;
+    return true;
+  }
+
+  std::optional<T> Pop() {
+    if (tail_ == batchTail_ && !ProbeFull()) {
+      return std::nullopt;
+    }
+
+    auto& slot = slots_[tail_ & mask_];
+    std::optional<T> val{std::move(*slot.Get())};
+    std::destroy_at(slot.Get());
+    slot.full.store(false, std::memory_order_release);
+    ++tail_;
+    return val;
+  }
+
+  // Maximum number of elements the queue can hold at once
+  size_t Capacity() const {
+    return mask_ + 1;
+  }
+
+private:
+  // Called by the producer when its batch is used up. The consumer frees slots in order, so a free
+  // slot `batch - 1` ahead means every slot up to it is free as well.
+  bool ProbeFree() {
+    for (size_t batch = batchSize_; batch > 0; batch /= 2) {
+      if (!slots_[(head_ + batch - 1) & mask_].full.load(std::memory_order_acquire)) {
+        batchHead_ = head_ + batch;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Called by the consumer when its batch is used up. The producer fills slots in order and
+  // publishes each with a release store, so seeing a full slot `batch - 1` ahead makes every
+  // element up to it visible.
+  bool ProbeFull() {
+    for (size_t batch = batchSize_; batch > 0; batch /= 2) {
+      if (slots_[(tail_ + batch - 1) & mask_].full.load(std::memory_order_acquire)) {
+        batchTail_ = tail_ + batch;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // read-only after construction, shared by both sides
+  alignas(os::kL1CacheLineSize) const size_t mask_;
+  const size_t batchSize_;
+  detail::SlotStorage<Slot> slots_;
+  // owned by the producer, slots [head_, batchHead_) are known to be free
+  alignas(os::kL1CacheLineSize) size_t head_{0};
+  size_t batchHead_{0};
+  // owned by the consumer, slots [tail_, batchTail_) are known to be full
+  alignas(os::kL1CacheLineSize) size_t tail_{0};
+  size_t batchTail_{0};
+};
+
+}  // namespace common::containers
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <bit>
+#include <common/containers/ring_buffer.hpp>
+#include <common/containers/ring_stats.hpp>
+#include <common/containers/slot_storage.hpp>
+#include <cstddef>
+
+namespace common::containers {
+
+namespace detail {
+
+// RingIndex<CapacityMode::PowerOfTwo> with the slot count baked in, so the mask is an immediate
+// operand instead of a load
+template <size_t SlotCount>
+  requires(std::has_single_bit(SlotCount))
+class FixedRingIndex {
+  static constexpr size_t kMask = SlotCount - 1;
+
+public:
+  FixedRingIndex() = default;
+
+  // The capacity is part of the type, the argument only mirrors RingIndex
+  explicit FixedRingIndex(size_t /* capacity */) {
+  }
+
+  static constexpr size_t Slots() {
+    return SlotCount;
+  }
+
+  static constexpr size_t Capacity() {
+    return SlotCount;
+  }
+
+  static constexpr size_t Slot(size_t idx) {
+    return idx & kMask;
+  }
+
+  // 64-bit indices never wrap in practice, unsigned overflow keeps `writeIdx - readIdx` correct
+  static constexpr size_t Next(size_t idx) {
+    return idx + 1;
+  }
+
+  static constexpr size_t Advance(size_t idx, size_t n) {
+    return idx + n;
+  }
+
+  static constexpr bool IsFull(size_t writeIdx, size_t readIdx) {
+    return writeIdx - readIdx > kMask;
+  }
+
+  static constexpr size_t Size(size_t writeIdx, size_t readIdx) {
+    return writeIdx - readIdx;
+  }
+};
+
+}  // namespace detail
+
+// FastRingBuffer with a capacity fixed at compile time. The slots are held inline, aligned to a
+// cache line, rather than behind a pointer to a heap block, and the index mask is a constant, so
+// every index computation folds into immediates and the ring can be embedded in a per-thread
+// structure without a separate allocation. N must be a power of two.
+//
+// Everything but the page backing options works as in FastRingBuffer, including lazy publication,
+// prefetching, stats and the blocking operations. A ring with a large N is best allocated on the
+// heap or in static storage rather than on a thread stack.
+template <typename T, size_t N, typename StatsPolicy = NoStats>
+  requires(std::has_single_bit(N))
+class FixedRingBuffer
+  : public BasicFastRingBuffer<T, detail::FixedRingIndex<N>, detail::InlineSlotStorage<T, N>,
+                               StatsPolicy> {
+  using Base =
+    BasicFastRingBuffer<T, detail::FixedRingIndex<N>, detail::InlineSlotStorage<T, N>, StatsPolicy>;
+
+public:
+  FixedRingBuffer(PublishOptions publish = {}, PrefetchOptions prefetch = {})
+    : Base(N, {}, publish, prefetch) {
+  }
+
+  // Maximum number of elements the buffer can hold at once
+  static constexpr size_t Capacity() {
+    return N;
+  }
+};
+
+}  // namespace common::containers
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <common/containers/ring_buffer.hpp>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <os/constants.hpp>
+#include <os/error.hpp>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace common::containers {
+
+namespace detail {
+
+// Identifies the running kernel instance, all zeros when unknown
+using BootId = std::array<char, 36>;
+
+inline BootId CurrentBootId() {
+  BootId id{};
+  int fd = ::open("/proc/sys/kernel/random/boot_id", O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return id;
+  }
+  if (::read(fd, id.data(), id.size()) != static_cast<ssize_t>(id.size())) {
+    id = {};
+  }
+  ::close(fd);
+  return id;
+}
+
+// Layout of the start of a journal file. The indices are free-running sequence numbers, so after
+// a restart they also tell how many elements were ever written and read.
+struct JournalHeader {
+  static constexpr uint64_t kMagic = 0x214c414e'52554f4a;  // "JOURNAL!" in little endian
+  static constexpr uint32_t kVersion = 1;
+
+  uint64_t magic;
+  uint32_t version;
+  uint32_t headerSize;
+  uint64_t elementSize;
+  uint64_t elementAlignment;
+  uint64_t slots;
+  uint64_t dataOffset;
+  uint64_t fileSize;
+  // boot the live indices below belong to
+  BootId bootId;
+  // written by Sync only once the slots they cover are on disk
+  uint64_t syncedReadIdx;
+  uint64_t syncedWriteIdx;
+  alignas(os::kL1CacheLineSize) std::atomic<uint64_t> readIdx;
+  alignas(os::kL1CacheLineSize) std::atomic<uint64_t> writeIdx;
+};
+
+}  // namespace detail
+
+// Persistent SPSC ring whose header and slots live in a memory-mapped file, for replaying the
+// messages a process had not consumed yet when it crashed.
+//
+// Push and Pop cost the same as in ShmRingBuffer: a memcpy into the mapping and a release store of
+// an index in the file header, no syscall. Sync, called periodically from a thread off the hot
+// path, msyncs the slots written since the last call and then records both indices as synced.
+// The producer only reuses a slot once a Sync has recorded its release, so the synced range is
+// never overwritten before a newer one is on disk. Without regular Sync calls the journal fills up.
+//
+// Open maps an existing journal without scanning it. After a process crash the page cache still
+// holds everything the process wrote, and the live indices are used. After a reboot, detected
+// through the kernel boot id, only the synced indices can be trusted: elements pushed after the
+// last Sync are lost and elements popped after it are replayed again.
+//
+// T has to be trivially copyable and must not hold pointers. Capacity is rounded up to a power of
+// two. A journal is locked by the process that has it open.
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+class JournalRingBuffer {
+  using Header = detail::JournalHeader;
+
+public:
+  // Creates the journal file at `path`, which must not exist yet, with its blocks allocated
+  static JournalRingBuffer Create(const char* path, size_t capacity) {
+    int fd = ::open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      os::ThrowErrno("open");
+    }
+    // a half initialized file would make every later Create of the path fail and Open reject it
+    try {
+      Lock(fd);
+
+      const size_t slots = std::bit_ceil(std::max<size_t>(capacity, 1));
+      const size_t dataOffset =
+        (sizeof(Header) + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+      const size_t fileSize = dataOffset + slots * sizeof(T);
+
+      // allocated up front, so writeback of the mapping never runs out of space
+      if (int error = ::posix_fallocate(fd, 0, static_cast<off_t>(fileSize)); error != 0) {
+        errno = error;
+        os::ThrowErrno("posix_fallocate", fd);
+      }
+      void* mapping = Map(fd, fileSize);
+
+      auto* header = ::new (mapping) Header{};
+      header->magic = Header::kMagic;
+      header->version = Header::kVersion;
+      header->headerSize = sizeof(Header);
+      header->elementSize = sizeof(T);
+      header->elementAlignment = alignof(T);
+      header->slots = slots;
+      header->dataOffset = dataOffset;
+      header->fileSize = fileSize;
+      header->bootId = detail::CurrentBootId();
+      if (::fsync(fd) != 0) {
+        ::munmap(mapping, fileSize);
+        os::ThrowErrno("fsync", fd);
+      }
+      return JournalRingBuffer(fd, mapping, false);
+    } catch (...) {
+      ::unlink(path);
+      throw;
+    }
+  }
+
+  // Maps the journal at `path` and recovers its indices. Throws when it is not a journal of T
+  // created by a compatible version, or when another process has it open.
+  static JournalRingBuffer Open(const char* path) {
+    int fd = ::open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+      os::ThrowErrno("open");
+    }
+    Lock(fd);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      os::ThrowErrno("fstat", fd);
+    }
+    const auto fileSize = static_cast<size_t>(st.st_size);
+    if (fileSize < sizeof(Header)) {
+      ::close(fd);
+      throw std::runtime_error("JournalRingBuffer: file is too small for a journal header");
+    }
+    void* mapping = Map(fd, fileSize);
+
+    auto* header = static_cast<Header*>(mapping);
+    const char* error = nullptr;
+    if (header->magic != Header::kMagic) {
+      error = "JournalRingBuffer: file does not hold a journal";
+    } else if (header->version != Header::kVersion || header->headerSize != sizeof(Header)) {
+      error = "JournalRingBuffer: journal was created by an incompatible version";
+    } else if (header->elementSize != sizeof(T) || header->elementAlignment != alignof(T)) {
+      error = "JournalRingBuffer: journal holds elements of a different type";
+    } else if (!std::has_single_bit(header->slots) || header->fileSize != fileSize ||
+               header->dataOffset % kDataAlignment != 0 ||
+               header->dataOffset + header->slots * sizeof(T) > fileSize ||
+               header->syncedWriteIdx - header->syncedReadIdx > header->slots) {
+      error = "JournalRingBuffer: journal header is corrupted";
+    }
+
+    const auto bootId = detail::CurrentBootId();
+    const bool rebooted = bootId == detail::BootId{} || header->bootId != bootId;
+    if (error == nullptr && rebooted) {
+      header->readIdx.store(header->syncedReadIdx, std::memory_order_relaxed);
+      header->writeIdx.store(header->syncedWriteIdx, std::memory_order_relaxed);
+      header->bootId = bootId;
+    }
+    auto const readIdx = header->readIdx.load(std::memory_order_relaxed);
+    auto const writeIdx = header->writeIdx.load(std::memory_order_relaxed);
+    if (error == nullptr &&
+        (writeIdx - readIdx > header->slots || writeIdx - header->syncedWriteIdx > header->slots ||
+         readIdx - header->syncedReadIdx > header->slots)) {
+      error = "JournalRingBuffer: journal header is corrupted";
+    }
+
+    if (error != nullptr) {
+      ::munmap(mapping, fileSize);
+      ::close(fd);
+      throw std::runtime_error(error);
+    }
+    return JournalRingBuffer(fd, mapping, rebooted);
+  }
+
+  JournalRingBuffer(JournalRingBuffer&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)),
+      mapping_(std::exchange(other.mapping_, nullptr)),
+      header_(other.header_),
+      data_(other.data_),
+      index_(other.index_),
+      rebooted_(other.rebooted_),
+      readIdxCached_(other.readIdxCached_),
+      writeIdxCached_(other.writeIdxCached_),
+      reclaimedIdx_(other.reclaimedIdx_.load(std::memory_order_relaxed)),
+      lastSyncedWriteIdx_(other.lastSyncedWriteIdx_) {
+  }
+
+  JournalRingBuffer& operator=(JournalRingBuffer&&) = delete;
+
+  // Does not Sync: the page cache keeps what was written unless the machine goes down
+  ~JournalRingBuffer() {
+    if (mapping_ != nullptr) {
+      ::munmap(mapping_, header_->fileSize);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  bool Push(const T& val) {
+    // can use relaxed due to Modification Ordering guarantee
+    auto const currentWriteIdx = header_->writeIdx.load(std::memory_order_relaxed);
+    if (index_.IsFull(currentWriteIdx, readIdxCached_)) {
+      readIdxCached_ = reclaimedIdx_.load(std::memory_order_acquire);
+      if (index_.IsFull(currentWriteIdx, readIdxCached_)) {
+        return false;
+      }
+    }
+
+    std::memcpy(data_ + index_.Slot(currentWriteIdx), &val, sizeof(T));
+    header_->writeIdx.store(index_.Next(currentWriteIdx), std::memory_order_release);
+    return true;
+  }
+
+  // Copies as many leading elements of `items` as fit and publishes them with a single store.
+  // Returns the number of elements pushed.
+  size_t PushBulk(std::span<const T> items) {
+    auto const currentWriteIdx = header_->writeIdx.load(std::memory_order_relaxed);
+    if (index_.Capacity() - index_.Size(currentWriteIdx, readIdxCached_) < items.size()) {
+      readIdxCached_ = reclaimedIdx_.load(std::memory_order_acquire);
+    }
+    const size_t count =
+      std::min(items.size(), index_.Capacity() - index_.Size(currentWriteIdx, readIdxCached_));
+
+    detail::ForEachRun(index_, currentWriteIdx, count, [&](size_t slot, size_t offset, size_t n) {
+      std::memcpy(data_ + slot, items.data() + offset, n * sizeof(T));
+    });
+
+    if (count > 0) {
+      header_->writeIdx.store(index_.Advance(currentWriteIdx, count), std::memory_order_release);
+    }
+    return count;
+  }
+
+  std::optional<T> Pop() {
+    // can use relaxed due to Modification Ordering guarantee
+    auto const readIdx = header_->readIdx.load(std::memory_order_relaxed);
+    if (readIdx == writeIdxCached_) {
+      writeIdxCached_ = header_->writeIdx.load(std::memory_order_acquire);
+      if (readIdx == writeIdxCached_) {
+        return std::nullopt;
+      }
+    }
+
+    std::optional<T> val{data_[index_.Slot(readIdx)]};
+    header_->readIdx.store(index_.Next(readIdx), std::memory_order_release);
+    return val;
+  }
+
+  // Copies up to `max` elements into `out` and releases their slots with a single store.
+  // Returns the number of elements popped.
+  template <std::output_iterator<const T&> OutputIt>
+  size_t PopBulk(OutputIt out, size_t max) {
+    // can use relaxed due to Modification Ordering guarantee
+    auto const readIdx = header_->readIdx.load(std::memory_order_relaxed);
+    if (index_.Size(writeIdxCached_, readIdx) < max) {
+      writeIdxCached_ = header_->writeIdx.load(std::memory_order_acquire);
+    }
+    const size_t count = std::min(max, index_.Size(writeIdxCached_, readIdx));
+
+    detail::ForEachRun(index_, readIdx, count, [&](size_t slot, size_t, size_t n) {
+      out = std::copy_n(data_ + slot, n, out);
+    });
+
+    if (count > 0) {
+      header_->readIdx.store(index_.Advance(readIdx, count), std::memory_order_release);
+    }
+    return count;
+  }
+
+  // Writes the slots pushed since the last Sync to disk, then the header recording the current
+  // indices, and finally lets the producer reuse the slots popped so far. Blocks for the disk
+  // writes, so call it from a thread other than the producer and the consumer, and from one
+  // thread at a time. Throws std::system_error when msync fails.
+  void Sync() {
+    // read index first: both only grow, so a write index loaded after it can never be behind it
+    auto const readIdx = header_->readIdx.load(std::memory_order_acquire);
+    auto const writeIdx = header_->writeIdx.load(std::memory_order_acquire);
+
+    detail::ForEachRun(index_, lastSyncedWriteIdx_, index_.Size(writeIdx, lastSyncedWriteIdx_),
+                       [&](size_t slot, size_t, size_t n) { Flush(data_ + slot, n * sizeof(T)); });
+
+    // Only the pair as of the msync below is durable. The kernel may write the page back earlier
+    // with just one of the two stores, Sync makes no promise about that state.
+    header_->syncedWriteIdx = writeIdx;
+    header_->syncedReadIdx = readIdx;
+    Flush(header_, sizeof(Header));
+
+    lastSyncedWriteIdx_ = writeIdx;
+    reclaimedIdx_.store(readIdx, std::memory_order_release);
+  }
+
+  // Whether Open found the journal written before a reboot and fell back to the synced indices
+  bool Rebooted() const {
+    return rebooted_;
+  }
+
+  // Sequence numbers of the next element to pop and to push, they keep counting across restarts
+  uint64_t ReadSequence() const {
+    return header_->readIdx.load(std::memory_order_acquire);
+  }
+
+  uint64_t WriteSequence() const {
+    return header_->writeIdx.load(std::memory_order_acquire);
+  }
+
+  // Maximum number of elements the journal can hold at once
+  size_t Capacity() const {
+    return index_.Capacity();
+  }
+
+private:
+  static constexpr size_t kDataAlignment = std::max(alignof(T), os::kL1CacheLineSize);
+
+  JournalRingBuffer(int fd, void* mapping, bool rebooted)
+    : fd_(fd),
+      mapping_(mapping),
+      header_(static_cast<Header*>(mapping)),
+      data_(reinterpret_cast<T*>(static_cast<std::byte*>(mapping) + header_->dataOffset)),
+      index_(header_->slots),
+      rebooted_(rebooted),
+      readIdxCached_(header_->syncedReadIdx),
+      writeIdxCached_(header_->readIdx.load(std::memory_order_relaxed)),
+      reclaimedIdx_(header_->syncedReadIdx),
+      lastSyncedWriteIdx_(header_->syncedWriteIdx) {
+  }
+
+  // Only one process may append to a journal, the lock goes away with the process
+  static void Lock(int fd) {
+    if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+      os::ThrowErrno("flock", fd);
+    }
+  }
+
+  static void* Map(int fd, size_t size) {
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      os::ThrowErrno("mmap", fd);
+    }
+    return mapping;
+  }
+
+  // msync wants a page aligned start, the mapping itself is page aligned
+  void Flush(const void* begin, size_t bytes) {
+    const auto offset = static_cast<size_t>(static_cast<const std::byte*>(begin) -
+                                            static_cast<const std::byte*>(mapping_));
+    const auto pageOffset = offset / os::kPageSize * os::kPageSize;
+    if (::msync(static_cast<std::byte*>(mapping_) + pageOffset, offset + bytes - pageOffset,
+                MS_SYNC) != 0) {
+      throw std::system_error(errno, std::generic_category(), "msync");
+    }
+  }
+
+  int fd_;
+  void* mapping_;
+  // both point into the mapping
+  Header* header_;
+  T* data_;
+  detail::RingIndex<CapacityMode::PowerOfTwo> index_;
+  bool rebooted_;
+  // only the producer's and the consumer's copy respectively are ever used
+  size_t readIdxCached_;
+  size_t writeIdxCached_;
+  // last readIdx recorded by Sync, the producer may overwrite slots before it
+  alignas(os::kL1CacheLineSize) std::atomic<uint64_t> reclaimedIdx_;
+  // owned by the thread calling Sync
+  alignas(os::kL1CacheLineSize) uint64_t lastSyncedWriteIdx_;
+};
+
+}  // namespace common::containers
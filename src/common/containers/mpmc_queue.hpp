@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <common/containers/ring_buffer.hpp>
+#include <common/containers/slot_storage.hpp>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <os/constants.hpp>
+#include <utility>
+
+namespace common::containers {
+
+// Bounded lock-free Multiple Producer Multiple Consumer queue after Dmitry Vyukov's array queue.
+//
+// Every slot carries a sequence number, so producers and consumers only synchronize through the
+// slot they claim and the index of their own side:
+// `seq == pos` - free for the producer that claims position `pos`
+// `seq == pos + 1` - published, readable by the consumer that claims position `pos`
+// `seq == pos + capacity` - consumed, free for the producer of the next lap
+// Positions are claimed with a CAS that only succeeds once the slot is ready, so Push fails fast
+// on a full queue and Pop on an empty one. Capacity is rounded up to a power of two, and to at
+// least 2: with a single slot `pos + 1` and `pos + capacity` are the same sequence, so a published
+// element would look free to the next producer.
+template <typename T>
+class MPMCQueue {
+public:
+  MPMCQueue(size_t capacity)
+    : index_(std::max<size_t>(capacity, 2)), slots_(detail::MakeSequencedSlots<T>(index_.Slots())) {
+  }
+
+  ~MPMCQueue() {
+    while (Pop()) {
+    }
+  }
+
+  bool Push(T val) {
+    return Emplace(std::move(val));
+  }
+
+  // Constructs the element directly in its slot. Returns false without constructing anything when
+  // the queue is full. If the constructor throws, the claimed slot is published as a skip marker
+  // that Pop steps over, and the exception propagates.
+  template <typename... Args>
+  bool Emplace(Args&&... args) {
+    auto pos = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& slot = slots_[index_.Slot(pos)];
+      auto const diff = Distance(slot.seq.load(std::memory_order_acquire), pos);
+      if (diff == 0) {
+        // on failure `pos` is reloaded with the current tail
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          try {
+            std::construct_at(slot.Get(), std::forward<Args>(args)...);
+          } catch (...) {
+            // the position is claimed, a consumer must still be able to move past it
+            slot.skip = true;
+            slot.seq.store(pos + 1, std::memory_order_release);
+            throw;
+          }
+          slot.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // the slot still holds an element of the previous lap
+        return false;
+      } else {
+        // another producer claimed `pos` already
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::optional<T> Pop() {
+    auto pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& slot = slots_[index_.Slot(pos)];
+      auto const diff = Distance(slot.seq.load(std::memory_order_acquire), pos + 1);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          if (slot.skip) {
+            slot.skip = false;
+            slot.seq.store(pos + index_.Slots(), std::memory_order_release);
+            pos = head_.load(std::memory_order_relaxed);
+            continue;
+          }
+          std::optional<T> val{std::move(*slot.Get())};
+          std::destroy_at(slot.Get());
+          slot.seq.store(pos + index_.Slots(), std::memory_order_release);
+          return val;
+        }
+      } else if (diff < 0) {
+        // nothing published at `pos` yet
+        return std::nullopt;
+      } else {
+        // another consumer claimed `pos` already
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Maximum number of elements the queue can hold at once
+  size_t Capacity() const {
+    return index_.Capacity();
+  }
+
+private:
+  static std::ptrdiff_t Distance(size_t seq, size_t expected) {
+    return static_cast<std::ptrdiff_t>(seq - expected);
+  }
+
+  // read-only after construction, shared by all threads
+  alignas(os::kL1CacheLineSize) detail::RingIndex<CapacityMode::PowerOfTwo> index_;
+  std::unique_ptr<detail::SequencedSlot<T>[]> slots_;
+  alignas(os::kL1CacheLineSize) std::atomic<size_t> tail_{0};
+  alignas(os::kL1CacheLineSize) std::atomic<size_t> head_{0};
+};
+
+}  // namespace common::containers
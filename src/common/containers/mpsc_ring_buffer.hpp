@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <common/containers/ring_buffer.hpp>
+#include <common/containers/slot_storage.hpp>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <os/constants.hpp>
+#include <thread/util/spin_wait.hpp>
+#include <utility>
+
+namespace common::containers {
+
+// Bounded lock-free Multiple Producer Single Consumer ring buffer.
+//
+// Producers claim a ticket with a single fetch_add on the shared tail, so they never retry under
+// contention. Every slot carries a sequence number that says whose turn it is:
+// `seq == ticket` - free for the producer holding `ticket`
+// `seq == ticket + 1` - published, readable by the consumer
+// `seq == ticket + capacity` - consumed, free for the producer of the next lap
+// Capacity is rounded up to a power of two, and to at least 2: with a single slot `ticket + 1`
+// and `ticket + capacity` are the same sequence, so a published element would look free to the
+// next producer.
+template <typename T>
+class MPSCRingBuffer {
+public:
+  MPSCRingBuffer(size_t capacity)
+    : index_(std::max<size_t>(capacity, 2)), slots_(detail::MakeSequencedSlots<T>(index_.Slots())) {
+  }
+
+  ~MPSCRingBuffer() {
+    while (Pop()) {
+    }
+  }
+
+  bool Push(T val) {
+    return Emplace(std::move(val));
+  }
+
+  // Constructs the element directly in its slot. Returns false without constructing anything when
+  // the buffer is seen full. A producer that passes that check while another one takes the last
+  // free slot has already claimed its ticket, and then spins until the consumer frees the slot, so
+  // Emplace can block for as long as the consumer is stalled. If the constructor throws, the slot
+  // is published as a skip marker that Pop steps over, and the exception propagates.
+  template <typename... Args>
+  bool Emplace(Args&&... args) {
+    // the admission check looks at the slot the next ticket maps to, which is touched anyway,
+    // instead of the consumer's index
+    auto const tail = tail_.load(std::memory_order_relaxed);
+    if (IsBehind(slots_[index_.Slot(tail)].seq.load(std::memory_order_acquire), tail)) {
+      return false;
+    }
+
+    auto const ticket = tail_.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = slots_[index_.Slot(ticket)];
+    // producers that raced past the admission check while the buffer was almost full wait for the
+    // consumer to free their slot
+    while (slot.seq.load(std::memory_order_acquire) != ticket) {
+      thread::util::SpinLoopHint();
+    }
+
+    try {
+      std::construct_at(slot.Get(), std::forward<Args>(args)...);
+    } catch (...) {
+      // the ticket is spent, the consumer must still be able to move past it
+      slot.skip = true;
+      slot.seq.store(ticket + 1, std::memory_order_release);
+      throw;
+    }
+    slot.seq.store(ticket + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::optional<T> Pop() {
+    for (;;) {
+      auto& slot = slots_[index_.Slot(head_)];
+      if (slot.seq.load(std::memory_order_acquire) != head_ + 1) {
+        return std::nullopt;
+      }
+
+      if (slot.skip) {
+        slot.skip = false;
+        slot.seq.store(head_ + index_.Slots(), std::memory_order_release);
+        ++head_;
+        continue;
+      }
+      std::optional<T> val{std::move(*slot.Get())};
+      std::destroy_at(slot.Get());
+      slot.seq.store(head_ + index_.Slots(), std::memory_order_release);
+      ++head_;
+      return val;
+    }
+  }
+
+  // Maximum number of elements the buffer can hold at once
+  size_t Capacity() const {
+    return index_.Capacity();
+  }
+
+private:
+  // true when the slot is still occupied by an element of the previous lap
+  static bool IsBehind(size_t seq, size_t ticket) {
+    return static_cast<std::ptrdiff_t>(seq - ticket) < 0;
+  }
+
+  // read-only after construction, shared by all threads
+  alignas(os::kL1CacheLineSize) detail::RingIndex<CapacityMode::PowerOfTwo> index_;
+  std::unique_ptr<detail::SequencedSlot<T>[]> slots_;
+  alignas(os::kL1CacheLineSize) std::atomic<size_t> tail_{0};
+  // owned by the consumer
+  alignas(os::kL1CacheLineSize) size_t head_{0};
+};
+
+}  // namespace common::containers
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <common/containers/ring_buffer.hpp>
+#include <common/containers/slot_storage.hpp>
+#include <initializer_list>
+#include <memory>
+#include <os/constants.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace common::containers {
+
+// Single producer broadcast ring in the style of the LMAX Disruptor.
+//
+// Every registered consumer sees every element. Consumers read elements in place and keep their
+// own cursor, so a message is stored once no matter how many consumers there are. The producer
+// gates on the slowest consumer, and a consumer can depend on other consumers to form a pipeline:
+// it only sees an element once all of its dependencies have released it.
+//
+// Consumers must be registered before the producer starts. Capacity is rounded up to a power of
+// two.
+template <typename T>
+class MulticastRingBuffer {
+public:
+  class Consumer {
+    friend class MulticastRingBuffer;
+
+  public:
+    Consumer(const Consumer&) = delete;
+    Consumer& operator=(const Consumer&) = delete;
+
+    // Returns up to `max` contiguous elements this consumer can read in place, empty when it has
+    // caught up with the producer or with its dependencies
+    std::span<const T> Peek(size_t max = 1) {
+      // can use relaxed due to Modification Ordering guarantee
+      auto const cursor = cursor_.load(std::memory_order_relaxed);
+      if (availableCached_ - cursor < max) {
+        availableCached_ = LoadBarrier();
+      }
+      const auto& index = ring_.index_;
+      const auto slot = index.Slot(cursor);
+      const size_t count = std::min({max, availableCached_ - cursor, index.Slots() - slot});
+      return {ring_.data_.Data() + slot, count};
+    }
+
+    // Marks the first `count` elements returned by the last Peek as processed by this consumer
+    void Release(size_t count) {
+      auto const cursor = cursor_.load(std::memory_order_relaxed);
+      cursor_.store(cursor + count, std::memory_order_release);
+    }
+
+  private:
+    Consumer(MulticastRingBuffer& ring, std::vector<const std::atomic<size_t>*> barrier)
+      : ring_(ring), barrier_(std::move(barrier)) {
+    }
+
+    // Number of elements every cursor this consumer waits on has gone past
+    size_t LoadBarrier() const {
+      size_t available = barrier_.front()->load(std::memory_order_acquire);
+      for (auto* cursor : std::span(barrier_).subspan(1)) {
+        available = std::min(available, cursor->load(std::memory_order_acquire));
+      }
+      return available;
+    }
+
+    MulticastRingBuffer& ring_;
+    // the producer's cursor, or the cursors of the consumers this one depends on
+    std::vector<const std::atomic<size_t>*> barrier_;
+    alignas(os::kL1CacheLineSize) std::atomic<size_t> cursor_{0};
+    alignas(os::kL1CacheLineSize) size_t availableCached_{0};
+  };
+
+  MulticastRingBuffer(size_t capacity, StorageOptions options = {})
+    : index_(capacity), data_(index_.Slots(), options) {
+  }
+
+  ~MulticastRingBuffer() {
+    // slots are only destroyed when the producer reuses them
+    auto const writeIdx = writeIdx_.load(std::memory_order_relaxed);
+    auto live = std::min(writeIdx, index_.Slots());
+    if (vacated_) {
+      // the oldest slot, the one the next Emplace goes into, no longer holds an element
+      --live;
+    }
+    detail::ForEachRun(index_, writeIdx - live, live,
+                       [this](size_t slot, size_t, size_t n) { data_.Destroy(slot, n); });
+  }
+
+  // Registers a consumer that sees an element once every consumer in `dependencies` has released
+  // it, or as soon as it is published when there are none. Not thread-safe, call before the
+  // producer starts.
+  Consumer& AddConsumer(std::initializer_list<const Consumer*> dependencies = {}) {
+    std::vector<const std::atomic<size_t>*> barrier;
+    for (auto* dependency : dependencies) {
+      barrier.push_back(&dependency->cursor_);
+    }
+    if (barrier.empty()) {
+      barrier.push_back(&writeIdx_);
+    }
+    consumers_.push_back(std::unique_ptr<Consumer>(new Consumer(*this, std::move(barrier))));
+    return *consumers_.back();
+  }
+
+  bool Push(T val) {
+    return Emplace(std::move(val));
+  }
+
+  // Constructs the element directly in its slot. Returns false without constructing anything when
+  // the slowest consumer is a full lap behind. If the constructor throws, nothing is published and
+  // the exception propagates.
+  template <typename... Args>
+  bool Emplace(Args&&... args) {
+    // can use relaxed due to Modification Ordering guarantee
+    auto const currentWriteIdx = writeIdx_.load(std::memory_order_relaxed);
+    if (index_.IsFull(currentWriteIdx, gateCached_)) {
+      gateCached_ = LoadSlowestCursor(currentWriteIdx);
+      if (index_.IsFull(currentWriteIdx, gateCached_)) {
+        return false;
+      }
+    }
+
+    const auto slot = index_.Slot(currentWriteIdx);
+    if (currentWriteIdx >= index_.Slots() && !vacated_) {
+      // every consumer has released the element of the previous lap
+      data_.Destroy(slot);
+      vacated_ = true;
+    }
+    data_.Construct(slot, std::forward<Args>(args)...);
+    vacated_ = false;
+    writeIdx_.store(index_.Next(currentWriteIdx), std::memory_order_release);
+    return true;
+  }
+
+  // Maximum number of elements the buffer can hold at once
+  size_t Capacity() const {
+    return index_.Capacity();
+  }
+
+private:
+  size_t LoadSlowestCursor(size_t writeIdx) const {
+    size_t slowest = writeIdx;
+    for (auto& consumer : consumers_) {
+      slowest = std::min(slowest, consumer->cursor_.load(std::memory_order_acquire));
+    }
+    return slowest;
+  }
+
+  // read-only after construction, shared by all threads
+  alignas(os::kL1CacheLineSize) detail::RingIndex<CapacityMode::PowerOfTwo> index_;
+  detail::SlotStorage<T> data_;
+  std::vector<std::unique_ptr<Consumer>> consumers_;
+  alignas(os::kL1CacheLineSize) std::atomic<size_t> writeIdx_{0};
+  // owned by the producer
+  alignas(os::kL1CacheLineSize) size_t gateCached_{0};
+  // set while the slot of the previous lap has been destroyed but its replacement has not been
+  // constructed yet, i.e. after a throwing constructor
+  bool vacated_{false};
+};
+
+}  // namespace common::containers
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <os/constants.hpp>
+#include <os/memory/numa.hpp>
+#include <os/memory/pages.hpp>
+#include <utility>
+
+namespace common::containers {
+
+namespace detail {
+
+template <typename Ring>
+struct NodeLocalDeleter {
+  void operator()(Ring* ring) const {
+    std::destroy_at(ring);
+    os::memory::Unmap({ring, os::memory::RoundUp(sizeof(Ring), os::kPageSize)});
+  }
+};
+
+}  // namespace detail
+
+template <typename Ring>
+using NodeLocalPtr = std::unique_ptr<Ring, detail::NodeLocalDeleter<Ring>>;
+
+// Constructs a ring in its own pages bound to NUMA node `node`.
+//
+// StorageOptions::numaNode only places the slots. The index cache lines (readIdx_, writeIdx_ and
+// the cached copies next to them) are members of the ring object and end up wherever it is
+// allocated, typically on the node of the thread that happened to construct it. Placing the
+// object itself puts them on the same node as the slots:
+//
+//   const int node = os::memory::NodeOfCpu(consumerCpu);
+//   auto ring = MakeNodeLocal<FastRingBuffer<Msg>>(node, capacity,
+//                                                  StorageOptions{.numaNode = node});
+//
+// Binding is best effort, the ring is still usable when the kernel has no NUMA support.
+template <typename Ring, typename... Args>
+NodeLocalPtr<Ring> MakeNodeLocal(int node, Args&&... args) {
+  auto mapping = os::memory::MapRegular(sizeof(Ring));
+  if (mapping.data == nullptr) {
+    throw std::bad_alloc();
+  }
+  if (node != os::memory::kAnyNode) {
+    os::memory::BindToNode(mapping.data, mapping.bytes, node);
+  }
+
+  try {
+    return NodeLocalPtr<Ring>(::new (mapping.data) Ring(std::forward<Args>(args)...));
+  } catch (...) {
+    os::memory::Unmap(mapping);
+    throw;
+  }
+}
+
+}  // namespace common::containers
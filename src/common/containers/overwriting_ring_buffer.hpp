@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <common/containers/slot_storage.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <os/constants.hpp>
+#include <type_traits>
+
+namespace common::containers {
+
+// Single Producer Single Consumer lossy ring where the latest data wins.
+//
+// Push never fails and never waits: when the consumer falls a full lap behind, the producer
+// overwrites the oldest entries. The producer does not even know where the consumer is, it only
+// writes slots. Every slot carries a sequence number saying which position it holds (odd while
+// the producer is writing it), so the consumer can tell an entry it has not seen yet from one
+// that was overwritten under it, and jump ahead counting what it skipped.
+//
+// The consumer may copy a slot while the producer overwrites it, so elements are stored as
+// atomic words and T must be trivially copyable. Capacity is rounded up to a power of two.
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+class OverwritingRingBuffer {
+  static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  struct Slot {
+    // 2 * position + 1 while the producer writes the slot, 2 * position + 2 once written
+    std::atomic<uint64_t> seq{0};
+    std::array<std::atomic<uint64_t>, kWords> words{};
+  };
+
+public:
+  explicit OverwritingRingBuffer(size_t capacity, StorageOptions options = {})
+    : mask_(std::bit_ceil(capacity) - 1), slots_(mask_ + 1, options) {
+    for (size_t i = 0; i <= mask_; ++i) {
+      slots_.Construct(i);
+    }
+  }
+
+  ~OverwritingRingBuffer() {
+    slots_.Destroy(0, mask_ + 1);
+  }
+
+  // Writes `val` over the oldest entry once the buffer is full
+  void Push(const T& val) {
+    std::array<uint64_t, kWords> words{};
+    std::memcpy(words.data(), &val, sizeof(T));
+
+    auto& slot = slots_[writeIdx_ & mask_];
+    // the release stores of the words keep this store ahead of them
+    slot.seq.store(2 * writeIdx_ + 1, std::memory_order_relaxed);
+    for (size_t i = 0; i < kWords; ++i) {
+      slot.words[i].store(words[i], std::memory_order_release);
+    }
+    slot.seq.store(2 * writeIdx_ + 2, std::memory_order_release);
+    ++writeIdx_;
+  }
+
+  // Returns the oldest entry not yet seen, or std::nullopt when the consumer has caught up. When
+  // the producer has lapped the consumer, the overwritten entries are skipped and added to
+  // Skipped().
+  std::optional<T> Pop() {
+    while (true) {
+      auto& slot = slots_[readIdx_ & mask_];
+      auto const seq = slot.seq.load(std::memory_order_acquire);
+      auto const expected = 2 * readIdx_ + 2;
+      if (seq < expected) {
+        // not written yet, or still being written
+        return std::nullopt;
+      }
+
+      if (seq == expected) {
+        std::array<uint64_t, kWords> words;
+        for (size_t i = 0; i < kWords; ++i) {
+          // acquire: a word from a newer write makes the seq reload below see that write
+          words[i] = slot.words[i].load(std::memory_order_acquire);
+        }
+        if (slot.seq.load(std::memory_order_relaxed) == seq) {
+          ++readIdx_;
+          std::array<std::byte, sizeof(T)> bytes;
+          std::memcpy(bytes.data(), words.data(), sizeof(T));
+          return std::bit_cast<T>(bytes);
+        }
+        // overwritten while copying, look at the slot again
+        continue;
+      }
+
+      // lapped: the slot holds (or is getting) a position at least a lap ahead, so the oldest
+      // entry that can still be in the buffer is one lap behind that
+      auto const newest = (seq - 1) / 2;
+      auto const oldest = newest + 1 - Capacity();
+      skipped_ += oldest - readIdx_;
+      readIdx_ = oldest;
+    }
+  }
+
+  // Number of entries the consumer lost to the producer overwriting them. Consumer side only.
+  uint64_t Skipped() const {
+    return skipped_;
+  }
+
+  // Number of entries the buffer keeps before overwriting the oldest
+  size_t Capacity() const {
+    return mask_ + 1;
+  }
+
+private:
+  // read-only after construction, shared by both sides
+  alignas(os::kL1CacheLineSize) const size_t mask_;
+  detail::SlotStorage<Slot> slots_;
+  // owned by the producer
+  alignas(os::kL1CacheLineSize) uint64_t writeIdx_{0};
+  // owned by the consumer
+  alignas(os::kL1CacheLineSize) uint64_t readIdx_{0};
+  uint64_t skipped_{0};
+};
+
+}  // namespace common::containers
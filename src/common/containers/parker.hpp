@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <os/constants.hpp>
+#include <os/futex/futex.hpp>
+#include <thread/util/spin_wait.hpp>
+
+namespace common::containers {
+
+// Number of failed attempts a blocking ring operation spins for before it parks on a futex
+inline constexpr size_t kDefaultSpinBudget = 256;
+
+namespace detail {
+
+// Lets one side of a ring sleep until the other side makes progress.
+//
+// `sleeping_` is both the waiter flag and the futex word. The waiter raises it before its last
+// attempt and the other side checks it after publishing. Each side puts a full fence between its
+// own store and its load of the other's, so either Notify sees the flag raised, or the waiter's
+// last attempt sees the published progress. While nobody sleeps, Notify is that fence and a plain
+// load of a line the waiter only reads, with no read-modify-write and no syscall. Only when it
+// finds the flag raised does it clear it with an exchange, which also makes sure that a single
+// notifier wakes the waiter.
+//
+// A waiter is only woken by Notify, so both sides of a ring have to use the blocking operations
+// whenever one of them may block.
+//
+// GCC's ThreadSanitizer rejects std::atomic_thread_fence, so sanitized builds instead order the
+// two sides with an exchange on `sleeping_` in Notify as well.
+//
+// With `Shared` set the futex calls are not process-private, so a Parker placed in a mapping shared
+// between processes wakes waiters in the other process.
+template <bool Shared>
+class BasicParker {
+  using Clock = std::chrono::steady_clock;
+
+public:
+  // Calls `tryOp` until its result converts to true and returns that result, spinning for
+  // `spinBudget` attempts before parking
+  template <typename TryOp>
+  auto Wait(TryOp&& tryOp, size_t spinBudget) {
+    return WaitUntil(tryOp, spinBudget, std::nullopt);
+  }
+
+  // Same as Wait, but gives up after `timeout` and returns the last, failed, result
+  template <typename TryOp>
+  auto WaitFor(TryOp&& tryOp, std::chrono::microseconds timeout, size_t spinBudget) {
+    return WaitUntil(tryOp, spinBudget, Clock::now() + timeout);
+  }
+
+  // Called by the other side after it has published progress
+  void Notify() {
+#if defined(__SANITIZE_THREAD__)
+    const bool raised = sleeping_.exchange(0, std::memory_order_acq_rel) != 0;
+#else
+    // orders the caller's publishing store before the load of the flag
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const bool raised = sleeping_.load(std::memory_order_relaxed) != 0 &&
+                        sleeping_.exchange(0, std::memory_order_acq_rel) != 0;
+#endif
+    if (raised) {
+      if constexpr (Shared) {
+        os::futex::WakeOneShared(Word());
+      } else {
+        os::futex::WakeOne(Word());
+      }
+    }
+  }
+
+private:
+  template <typename TryOp>
+  auto WaitUntil(TryOp& tryOp, size_t spinBudget, std::optional<Clock::time_point> deadline) {
+    for (size_t i = 0; i < spinBudget; ++i) {
+      if (auto result = tryOp()) {
+        return result;
+      }
+      thread::util::SpinLoopHint();
+    }
+
+    for (;;) {
+      sleeping_.exchange(1, std::memory_order_acq_rel);
+#if !defined(__SANITIZE_THREAD__)
+      // orders the raised flag before the loads of the last attempt
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+      auto result = tryOp();
+      if (result) {
+        sleeping_.store(0, std::memory_order_relaxed);
+        return result;
+      }
+
+      if (!deadline) {
+        if constexpr (Shared) {
+          os::futex::WaitShared(Word(), /* old */ 1);
+        } else {
+          os::futex::Wait(Word(), /* old */ 1);
+        }
+        continue;
+      }
+      auto const now = Clock::now();
+      if (now >= *deadline) {
+        sleeping_.store(0, std::memory_order_relaxed);
+        return result;
+      }
+      auto const micros = std::chrono::ceil<std::chrono::microseconds>(*deadline - now).count();
+      auto const clamped =
+        static_cast<uint32_t>(std::min<int64_t>(micros, std::numeric_limits<uint32_t>::max()));
+      if constexpr (Shared) {
+        os::futex::WaitTimedShared(Word(), /* old */ 1, clamped);
+      } else {
+        os::futex::WaitTimed(Word(), /* old */ 1, clamped);
+      }
+    }
+  }
+
+  uint32_t* Word() {
+    return reinterpret_cast<uint32_t*>(&sleeping_);
+  }
+
+  alignas(os::kL1CacheLineSize) std::atomic<uint32_t> sleeping_{0};
+};
+
+using Parker = BasicParker<false>;
+using SharedParker = BasicParker<true>;
+
+}  // namespace detail
+
+}  // namespace common::containers
@@ -1,36 +1,179 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
+#include <chrono>
+#include <common/containers/bulk_copy.hpp>
+#include <common/containers/parker.hpp>
+#include <common/containers/ring_stats.hpp>
+#include <common/containers/slot_storage.hpp>
+#include <concepts>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <os/constants.hpp>
-#include <vector>
+#include <span>
+#include <type_traits>
 
 namespace common::containers {
 
-template <typename T>
+enum class CapacityMode {
+  // Indices wrap with `%` and one slot is kept empty to tell a full ring from an empty one
+  Modulo,
+  // Capacity is rounded up to a power of two, indices run freely and are mapped onto slots
+  // with a mask, so every slot is usable and no division is done on the hot path
+  PowerOfTwo,
+};
+
+namespace detail {
+
+template <CapacityMode Mode>
+class RingIndex;
+
+template <>
+class RingIndex<CapacityMode::Modulo> {
+public:
+  explicit RingIndex(size_t capacity) : capacity_(capacity) {
+  }
+
+  size_t Slots() const {
+    return capacity_;
+  }
+
+  size_t Capacity() const {
+    return capacity_ - 1;
+  }
+
+  size_t Slot(size_t idx) const {
+    return idx;
+  }
+
+  size_t Next(size_t idx) const {
+    return (idx + 1) % capacity_;
+  }
+
+  // `n` must not exceed Capacity()
+  size_t Advance(size_t idx, size_t n) const {
+    idx += n;
+    return idx >= capacity_ ? idx - capacity_ : idx;
+  }
+
+  bool IsFull(size_t writeIdx, size_t readIdx) const {
+    return Next(writeIdx) == readIdx;
+  }
+
+  size_t Size(size_t writeIdx, size_t readIdx) const {
+    return writeIdx >= readIdx ? writeIdx - readIdx : writeIdx + capacity_ - readIdx;
+  }
+
+private:
+  size_t capacity_;
+};
+
+template <>
+class RingIndex<CapacityMode::PowerOfTwo> {
+public:
+  explicit RingIndex(size_t capacity) : mask_(std::bit_ceil(capacity) - 1) {
+  }
+
+  size_t Slots() const {
+    return mask_ + 1;
+  }
+
+  size_t Capacity() const {
+    return mask_ + 1;
+  }
+
+  size_t Slot(size_t idx) const {
+    return idx & mask_;
+  }
+
+  // 64-bit indices never wrap in practice, unsigned overflow keeps `writeIdx - readIdx` correct
+  size_t Next(size_t idx) const {
+    return idx + 1;
+  }
+
+  size_t Advance(size_t idx, size_t n) const {
+    return idx + n;
+  }
+
+  bool IsFull(size_t writeIdx, size_t readIdx) const {
+    return writeIdx - readIdx > mask_;
+  }
+
+  size_t Size(size_t writeIdx, size_t readIdx) const {
+    return writeIdx - readIdx;
+  }
+
+private:
+  size_t mask_;
+};
+
+// Splits `count` elements starting at index `idx` into at most two contiguous runs of slots and
+// calls `fn(slot, offset, n)` for each, `offset` being the position of the run within the batch
+template <typename Index, typename Fn>
+void ForEachRun(const Index& index, size_t idx, size_t count, Fn&& fn) {
+  const auto slot = index.Slot(idx);
+  const auto firstRun = std::min(count, index.Slots() - slot);
+  if (firstRun > 0) {
+    fn(slot, size_t{0}, firstRun);
+  }
+  if (count > firstRun) {
+    fn(size_t{0}, firstRun, count - firstRun);
+  }
+}
+
+// Calls `fn` on each of the `count` elements from index `idx` in place, then destroys them
+template <typename Index, typename Storage, typename Fn>
+void ConsumeInPlace(const Index& index, Storage& data, size_t idx, size_t count, Fn& fn) {
+  ForEachRun(index, idx, count, [&](size_t slot, size_t, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      fn(data[slot + i]);
+    }
+    data.Destroy(slot, n);
+  });
+}
+
+}  // namespace detail
+
+// Lock-free SPSC ring buffer.
+//
+// The blocking operations only wake each other: a consumer parked in WaitPop is not woken by
+// Push/Emplace/TryEmplace, and a producer parked in WaitPush is not woken by Pop/ConsumeAll. When
+// one side may block, the other side has to use the Wait* operations as well.
+template <typename T, CapacityMode Mode = CapacityMode::Modulo>
 class RingBuffer {
 public:
-  RingBuffer(size_t capacity) : capacity_(capacity) {
-    data_.reserve(capacity_);
+  RingBuffer(size_t capacity, StorageOptions options = {})
+    : index_(capacity), data_(index_.Slots(), options) {
+  }
+
+  ~RingBuffer() {
+    auto const readIdx = readIdx_.load(std::memory_order_relaxed);
+    auto const count = index_.Size(writeIdx_.load(std::memory_order_relaxed), readIdx);
+    detail::ForEachRun(index_, readIdx, count,
+                       [this](size_t slot, size_t, size_t n) { data_.Destroy(slot, n); });
   }
 
   bool Push(T val) {
-    // can use relaxed due to Modification Ordering guarantee
-    const auto currentWriteIdx = writeIdx_.load(std::memory_order_relaxed);
-    auto nextWriteIdx = (currentWriteIdx + 1) % capacity_;
-    if (nextWriteIdx == readIdx_.load(std::memory_order_acquire)) {
-      return false;
-    }
+    return Emplace(std::move(val));
+  }
 
-    // lazy construction
-    if (currentWriteIdx >= data_.size()) {
-      data_.emplace_back(std::move(val));
-    } else {
-      data_[currentWriteIdx] = std::move(val);
-    }
+  // Constructs the element directly in its slot. Fails without constructing anything when the
+  // buffer is full.
+  template <typename... Args>
+  bool Emplace(Args&&... args) {
+    return PushWith([&](size_t slot) { data_.Construct(slot, std::forward<Args>(args)...); });
+  }
 
-    writeIdx_.store(nextWriteIdx, std::memory_order_release);
-    return true;
+  // Constructs the element in its slot from the value returned by `factory`. The factory is only
+  // invoked when there is room, so a full buffer costs no work at all.
+  template <std::invocable Factory>
+    requires std::same_as<std::invoke_result_t<Factory>, T>
+  bool TryEmplace(Factory&& factory) {
+    return PushWith([&](size_t slot) { data_.ConstructWith(slot, std::forward<Factory>(factory)); });
   }
 
   std::optional<T> Pop() {
@@ -39,69 +182,539 @@ public:
     if (readIdx == writeIdx_.load(std::memory_order_acquire)) {
       return std::nullopt;
     }
-    auto val = std::move(data_[readIdx]);
-    auto nextReadIdx = (readIdx + 1) % capacity_;
-    readIdx_.store(nextReadIdx, std::memory_order_release);
+    const auto slot = index_.Slot(readIdx);
+    std::optional<T> val{std::move(data_[slot])};
+    data_.Destroy(slot);
+    readIdx_.store(index_.Next(readIdx), std::memory_order_release);
+    return val;
+  }
+
+  // Calls `fn(T&)` on every available element in place, in order, then destroys them and hands
+  // their slots back with a single store. Loads the write index once. `fn` may move from the
+  // element. Returns the number of elements consumed.
+  template <std::invocable<T&> Fn>
+  size_t ConsumeAll(Fn&& fn) {
+    return ConsumeUpTo(std::numeric_limits<size_t>::max(), fn);
+  }
+
+  // Same as ConsumeAll, but stops after `max` elements
+  template <std::invocable<T&> Fn>
+  size_t ConsumeUpTo(size_t max, Fn&& fn) {
+    // can use relaxed due to Modification Ordering guarantee
+    auto const readIdx = readIdx_.load(std::memory_order_relaxed);
+    const size_t count =
+      std::min(max, index_.Size(writeIdx_.load(std::memory_order_acquire), readIdx));
+    detail::ConsumeInPlace(index_, data_, readIdx, count, fn);
+    if (count > 0) {
+      readIdx_.store(index_.Advance(readIdx, count), std::memory_order_release);
+    }
+    return count;
+  }
+
+  // Blocking Push: spins for `spinBudget` attempts while the buffer is full, then parks until a
+  // WaitPop frees a slot. Plain Pop does not wake a parked producer.
+  void WaitPush(T val, size_t spinBudget = kDefaultSpinBudget) {
+    producerParker_.Wait([&] { return Emplace(std::move(val)); }, spinBudget);
+    consumerParker_.Notify();
+  }
+
+  // Same as WaitPush, but gives up after `timeout`. `val` is only moved from on success.
+  bool WaitPushFor(T&& val, std::chrono::microseconds timeout,
+                   size_t spinBudget = kDefaultSpinBudget) {
+    if (!producerParker_.WaitFor([&] { return Emplace(std::move(val)); }, timeout, spinBudget)) {
+      return false;
+    }
+    consumerParker_.Notify();
+    return true;
+  }
+
+  // Blocking Pop: spins for `spinBudget` attempts while the buffer is empty, then parks until a
+  // WaitPush publishes an element. Plain Push does not wake a parked consumer.
+  T WaitPop(size_t spinBudget = kDefaultSpinBudget) {
+    auto val = consumerParker_.Wait([this] { return Pop(); }, spinBudget);
+    producerParker_.Notify();
+    return std::move(*val);
+  }
+
+  // Same as WaitPop, but returns std::nullopt after `timeout`
+  std::optional<T> WaitPopFor(std::chrono::microseconds timeout,
+                              size_t spinBudget = kDefaultSpinBudget) {
+    auto val = consumerParker_.WaitFor([this] { return Pop(); }, timeout, spinBudget);
+    if (val) {
+      producerParker_.Notify();
+    }
     return val;
   }
 
+  // Maximum number of elements the buffer can hold at once
+  size_t Capacity() const {
+    return index_.Capacity();
+  }
+
+  // What backs the slots, see StorageOptions
+  os::memory::PageBacking Backing() const {
+    return data_.Backing();
+  }
+
+  // NUMA node the slots are bound to, see StorageOptions
+  int NumaNode() const {
+    return data_.Node();
+  }
+
 private:
-  std::vector<T> data_{};
-  alignas(os::kL1CacheLineSize) size_t capacity_{0};
+  template <typename ConstructFn>
+  bool PushWith(ConstructFn&& construct) {
+    // can use relaxed due to Modification Ordering guarantee
+    const auto currentWriteIdx = writeIdx_.load(std::memory_order_relaxed);
+    if (index_.IsFull(currentWriteIdx, readIdx_.load(std::memory_order_acquire))) {
+      return false;
+    }
+
+    construct(index_.Slot(currentWriteIdx));
+    writeIdx_.store(index_.Next(currentWriteIdx), std::memory_order_release);
+    return true;
+  }
+
+  // read-only after construction, shared by both sides
+  alignas(os::kL1CacheLineSize) detail::RingIndex<Mode> index_;
+  detail::SlotStorage<T> data_;
   alignas(os::kL1CacheLineSize) std::atomic<size_t> readIdx_{0};
   alignas(os::kL1CacheLineSize) std::atomic<size_t> writeIdx_{0};
+  // only touched by the Wait* operations
+  detail::Parker producerParker_;
+  detail::Parker consumerParker_;
+};
+
+// When FastRingBuffer makes its indices visible to the other side. By default every Push and Pop
+// publishes with a release store to a line the other side keeps reading, which costs a coherence
+// miss per element. Larger batches trade latency for throughput: the other side sees the elements
+// (or the freed slots) at most `batch` operations late, or earlier on an explicit flush. A side
+// that finds the buffer full (or empty) always publishes what it has first, so the two sides can
+// never wait on each other's unpublished indices.
+struct PublishOptions {
+  // The producer publishes its writes every `producerBatch` elements, or on Flush
+  size_t producerBatch = 1;
+  // The consumer hands slots back every `consumerBatch` elements, or on FlushConsumed
+  size_t consumerBatch = 1;
 };
 
-template <typename T>
-class FastRingBuffer {
+// How far ahead FastRingBuffer prefetches slots, in elements, 0 for not at all. Worth it when
+// elements span several cache lines or the ring is much larger than L2, where the consumer would
+// otherwise stall on the next slot. Each side only prefetches slots it already owns: the consumer
+// elements it knows are published, the producer slots it knows are free, so a prefetch never
+// pulls a line away from the other side while it is still using it.
+struct PrefetchOptions {
+  // The consumer prefetches the element this many slots past the one it pops, for reading
+  size_t consumerDistance = 0;
+  // The producer prefetches the slot this many slots past the one it pushes into, for writing
+  size_t producerDistance = 0;
+};
+
+// SPSC ring buffer that caches the other side's index, so it only touches the shared line when
+// the cached copy runs out. `StatsPolicy` is NoStats or CountingStats, see ring_stats.hpp.
+//
+// As in RingBuffer, a parked WaitPop or WaitPush is only woken by the opposite Wait* operation, not
+// by Push/Emplace/PushBulk/Commit or Pop/PopBulk/Release/ConsumeAll. When one side may block, the
+// other side has to use the Wait* operations as well.
+//
+// `Index` maps indices onto slots like detail::RingIndex, and `Storage` holds the slots like
+// detail::SlotStorage. Use FastRingBuffer, or FixedRingBuffer for a capacity known at compile time.
+template <typename T, typename Index, typename Storage, typename StatsPolicy = NoStats>
+class BasicFastRingBuffer {
 public:
-  FastRingBuffer(size_t capacity) : capacity_(capacity) {
-    data_.reserve(capacity);
+  BasicFastRingBuffer(size_t capacity, StorageOptions options = {}, PublishOptions publish = {},
+                      PrefetchOptions prefetch = {})
+    : index_(capacity),
+      data_(index_.Slots(), options),
+      producerBatch_(std::max<size_t>(publish.producerBatch, 1)),
+      consumerBatch_(std::max<size_t>(publish.consumerBatch, 1)),
+      producerPrefetch_(std::min(prefetch.producerDistance, index_.Capacity())),
+      consumerPrefetch_(std::min(prefetch.consumerDistance, index_.Capacity())) {
+  }
+
+  ~BasicFastRingBuffer() {
+    // the local indices also cover elements that were never published
+    auto const count = index_.Size(localWriteIdx_, localReadIdx_);
+    detail::ForEachRun(index_, localReadIdx_, count,
+                       [this](size_t slot, size_t, size_t n) { data_.Destroy(slot, n); });
   }
 
   bool Push(T val) {
-    // can use relaxed due to Modification Ordering guarantee
-    auto const currentWriteIdx = writeIdx_.load(std::memory_order_relaxed);
-    auto nextWriteIdx = (currentWriteIdx + 1) % capacity_;
-    if (nextWriteIdx == readIdxCached_) {
-      readIdxCached_ = readIdx_.load(std::memory_order_acquire);
-      if (nextWriteIdx == readIdxCached_) {
-        return false;
+    return Emplace(std::move(val));
+  }
+
+  // Constructs the element directly in its slot. Fails without constructing anything when the
+  // buffer is full.
+  template <typename... Args>
+  bool Emplace(Args&&... args) {
+    return PushWith([&](size_t slot) { data_.Construct(slot, std::forward<Args>(args)...); });
+  }
+
+  // Constructs the element in its slot from the value returned by `factory`. The factory is only
+  // invoked when there is room, so a full buffer costs no work at all.
+  template <std::invocable Factory>
+    requires std::same_as<std::invoke_result_t<Factory>, T>
+  bool TryEmplace(Factory&& factory) {
+    return PushWith([&](size_t slot) { data_.ConstructWith(slot, std::forward<Factory>(factory)); });
+  }
+
+  // Pushes as many leading elements of `items` as fit and publishes them with a single store.
+  // Elements are moved out of `items`, or copied when it is a span of const T. Trivially copyable
+  // elements are copied with one memcpy per contiguous run instead, or with non-temporal stores
+  // for CopyMode::NonTemporal, which other types ignore.
+  // Returns the number of elements pushed.
+  template <typename U>
+    requires std::same_as<std::remove_const_t<U>, T>
+  size_t PushBulk(std::span<U> items, CopyMode mode = CopyMode::Cached) {
+    auto const currentWriteIdx = localWriteIdx_;
+    if (index_.Capacity() - index_.Size(currentWriteIdx, readIdxCached_) < items.size()) {
+      RefreshReadIdx();
+    }
+    const size_t count =
+      std::min(items.size(), index_.Capacity() - index_.Size(currentWriteIdx, readIdxCached_));
+    if (count == 0 && !items.empty()) {
+      producerStats_.PushFull();
+    }
+
+    detail::ForEachRun(index_, currentWriteIdx, count, [&](size_t slot, size_t offset, size_t n) {
+      if constexpr (std::is_trivially_copyable_v<T>) {
+        detail::CopyElements(data_.Data() + slot, items.data() + offset, n, mode);
+      } else if constexpr (std::is_const_v<U>) {
+        std::uninitialized_copy_n(items.data() + offset, n, data_.Data() + slot);
+      } else {
+        std::uninitialized_move_n(items.data() + offset, n, data_.Data() + slot);
       }
+    });
+
+    localWriteIdx_ = index_.Advance(currentWriteIdx, count);
+    PublishWrites(count);
+    if (count < items.size()) {
+      Flush();
     }
+    return count;
+  }
 
-    // lazy construction
-    if (currentWriteIdx >= data_.size()) {
-      data_.emplace_back(std::move(val));
-    } else {
-      data_[currentWriteIdx] = std::move(val);
+  // Returns up to `max` contiguous uninitialized slots the producer can construct into in place
+  // (std::construct_at, or plain assignment for trivially copyable T), empty when the buffer is
+  // full. Fewer than `max` slots are returned near the end of the storage, Reserve again after
+  // Commit.
+  std::span<T> Reserve(size_t max = 1) {
+    auto const currentWriteIdx = localWriteIdx_;
+    if (index_.Capacity() - index_.Size(currentWriteIdx, readIdxCached_) < max) {
+      RefreshReadIdx();
+    }
+    const auto slot = index_.Slot(currentWriteIdx);
+    const size_t count =
+      std::min({max, index_.Capacity() - index_.Size(currentWriteIdx, readIdxCached_),
+                index_.Slots() - slot});
+    if (count == 0 && max > 0) {
+      producerStats_.PushFull();
+      Flush();
+    }
+    return {data_.Data() + slot, count};
+  }
+
+  // Publishes the first `count` slots returned by the last Reserve, all of which must have been
+  // constructed. With a producer batch they become visible once the batch is full.
+  void Commit(size_t count) {
+    localWriteIdx_ = index_.Advance(localWriteIdx_, count);
+    PublishWrites(count);
+  }
+
+  // Makes every element pushed so far visible to the consumer. Only needed with a producer batch
+  // larger than one, e.g. at the end of a burst.
+  void Flush() {
+    if (unpublishedWrites_ != 0) {
+      writeIdx_.store(localWriteIdx_, std::memory_order_release);
+      unpublishedWrites_ = 0;
     }
-    writeIdx_.store(nextWriteIdx, std::memory_order_release);
-    return true;
   }
 
   std::optional<T> Pop() {
-    // can use relaxed due to Modification Ordering guarantee
-    auto const readIdx = readIdx_.load(std::memory_order_relaxed);
+    auto const readIdx = localReadIdx_;
     if (readIdx == writeIdxCached_) {
-      writeIdxCached_ = writeIdx_.load(std::memory_order_acquire);
+      RefreshWriteIdx(readIdx);
       if (readIdx == writeIdxCached_) {
+        consumerStats_.PopEmpty();
+        FlushConsumed();
         return std::nullopt;
       }
     }
-    auto val = std::move(data_[readIdx]);
-    auto nextReadIdx = (readIdx + 1) % capacity_;
-    readIdx_.store(nextReadIdx, std::memory_order_release);
+    PrefetchForRead(readIdx);
+    const auto slot = index_.Slot(readIdx);
+    std::optional<T> val{std::move(data_[slot])};
+    data_.Destroy(slot);
+    localReadIdx_ = index_.Next(readIdx);
+    PublishReads(1);
     return val;
   }
 
+  // Moves up to `max` elements into `out` and releases their slots with a single store. Trivially
+  // copyable elements go out with one memcpy per contiguous run when `out` is contiguous, e.g. a
+  // T*, and `mode` picks cached or non-temporal stores into it as for PushBulk.
+  // Returns the number of elements popped.
+  template <std::output_iterator<T&&> OutputIt>
+  size_t PopBulk(OutputIt out, size_t max, CopyMode mode = CopyMode::Cached) {
+    auto const readIdx = localReadIdx_;
+    if (index_.Size(writeIdxCached_, readIdx) < max) {
+      RefreshWriteIdx(readIdx);
+    }
+    const size_t count = std::min(max, index_.Size(writeIdxCached_, readIdx));
+    if (count == 0 && max > 0) {
+      consumerStats_.PopEmpty();
+    }
+
+    detail::ForEachRun(index_, readIdx, count, [&](size_t slot, size_t, size_t n) {
+      T* first = &data_[slot];
+      if constexpr (std::is_trivially_copyable_v<T> && detail::ContiguousOutputOf<OutputIt, T>) {
+        detail::CopyElements(std::to_address(out), first, n, mode);
+        out += n;
+      } else {
+        out = std::move(first, first + n, out);
+      }
+      data_.Destroy(slot, n);
+    });
+
+    localReadIdx_ = index_.Advance(readIdx, count);
+    PublishReads(count);
+    if (count < max) {
+      FlushConsumed();
+    }
+    return count;
+  }
+
+  // Returns up to `max` contiguous elements the consumer can process in place, empty when the
+  // buffer is empty. The elements stay owned by the buffer until Release.
+  std::span<T> Peek(size_t max = 1) {
+    auto const readIdx = localReadIdx_;
+    if (index_.Size(writeIdxCached_, readIdx) < max) {
+      RefreshWriteIdx(readIdx);
+    }
+    const auto slot = index_.Slot(readIdx);
+    const size_t count =
+      std::min({max, index_.Size(writeIdxCached_, readIdx), index_.Slots() - slot});
+    if (count == 0) {
+      if (max > 0) {
+        consumerStats_.PopEmpty();
+        FlushConsumed();
+      }
+      return {};
+    }
+    return {&data_[slot], count};
+  }
+
+  // Destroys the first `count` elements returned by the last Peek and hands their slots back to
+  // the producer, once the consumer batch is full
+  void Release(size_t count) {
+    data_.Destroy(index_.Slot(localReadIdx_), count);
+    localReadIdx_ = index_.Advance(localReadIdx_, count);
+    PublishReads(count);
+  }
+
+  // Hands every slot consumed so far back to the producer. Only needed with a consumer batch
+  // larger than one.
+  void FlushConsumed() {
+    if (unpublishedReads_ != 0) {
+      readIdx_.store(localReadIdx_, std::memory_order_release);
+      unpublishedReads_ = 0;
+    }
+  }
+
+  // Calls `fn(T&)` on every available element in place, in order, then destroys them and hands
+  // their slots back with a single store. Reloads the write index once, whatever the cached copy
+  // says, and always publishes since it leaves the buffer empty. `fn` may move from the element.
+  // Returns the number of elements consumed.
+  template <std::invocable<T&> Fn>
+  size_t ConsumeAll(Fn&& fn) {
+    auto const readIdx = localReadIdx_;
+    RefreshWriteIdx(readIdx);
+    const size_t count = index_.Size(writeIdxCached_, readIdx);
+    if (count == 0) {
+      consumerStats_.PopEmpty();
+    }
+    detail::ConsumeInPlace(index_, data_, readIdx, count, fn);
+    localReadIdx_ = index_.Advance(readIdx, count);
+    unpublishedReads_ += count;
+    FlushConsumed();
+    return count;
+  }
+
+  // Same as ConsumeAll, but stops after `max` elements. The write index is only reloaded when the
+  // cached copy shows fewer, and the slots are handed back like Release does.
+  template <std::invocable<T&> Fn>
+  size_t ConsumeUpTo(size_t max, Fn&& fn) {
+    auto const readIdx = localReadIdx_;
+    if (index_.Size(writeIdxCached_, readIdx) < max) {
+      RefreshWriteIdx(readIdx);
+    }
+    const size_t count = std::min(max, index_.Size(writeIdxCached_, readIdx));
+    if (count == 0 && max > 0) {
+      consumerStats_.PopEmpty();
+    }
+    detail::ConsumeInPlace(index_, data_, readIdx, count, fn);
+    localReadIdx_ = index_.Advance(readIdx, count);
+    PublishReads(count);
+    if (count < max) {
+      FlushConsumed();
+    }
+    return count;
+  }
+
+  // Blocking Push: spins for `spinBudget` attempts while the buffer is full, then parks until a
+  // WaitPop frees a slot. Plain Pop does not wake a parked producer. The element is published
+  // right away whatever the producer batch.
+  void WaitPush(T val, size_t spinBudget = kDefaultSpinBudget) {
+    producerParker_.Wait([&] { return Emplace(std::move(val)); }, spinBudget);
+    Flush();
+    consumerParker_.Notify();
+  }
+
+  // Same as WaitPush, but gives up after `timeout`. `val` is only moved from on success.
+  bool WaitPushFor(T&& val, std::chrono::microseconds timeout,
+                   size_t spinBudget = kDefaultSpinBudget) {
+    if (!producerParker_.WaitFor([&] { return Emplace(std::move(val)); }, timeout, spinBudget)) {
+      return false;
+    }
+    Flush();
+    consumerParker_.Notify();
+    return true;
+  }
+
+  // Blocking Pop: spins for `spinBudget` attempts while the buffer is empty, then parks until a
+  // WaitPush publishes an element. Plain Push does not wake a parked consumer. The slot is handed
+  // back right away whatever the consumer batch.
+  T WaitPop(size_t spinBudget = kDefaultSpinBudget) {
+    auto val = consumerParker_.Wait([this] { return Pop(); }, spinBudget);
+    FlushConsumed();
+    producerParker_.Notify();
+    return std::move(*val);
+  }
+
+  // Same as WaitPop, but returns std::nullopt after `timeout`
+  std::optional<T> WaitPopFor(std::chrono::microseconds timeout,
+                              size_t spinBudget = kDefaultSpinBudget) {
+    auto val = consumerParker_.WaitFor([this] { return Pop(); }, timeout, spinBudget);
+    if (val) {
+      FlushConsumed();
+      producerParker_.Notify();
+    }
+    return val;
+  }
+
+  // Maximum number of elements the buffer can hold at once
+  size_t Capacity() const {
+    return index_.Capacity();
+  }
+
+  // What backs the slots, see StorageOptions
+  os::memory::PageBacking Backing() const {
+    return data_.Backing();
+  }
+
+  // NUMA node the slots are bound to, see StorageOptions
+  int NumaNode() const {
+    return data_.Node();
+  }
+
+  // Snapshot of the counters, all zero with NoStats. Safe to call from any thread.
+  RingStats Stats() const {
+    RingStats stats;
+    producerStats_.Snapshot(stats);
+    consumerStats_.Snapshot(stats);
+    return stats;
+  }
+
 private:
-  std::vector<T> data_{};
-  alignas(os::kL1CacheLineSize) size_t capacity_{0};
+  template <typename ConstructFn>
+  bool PushWith(ConstructFn&& construct) {
+    auto const currentWriteIdx = localWriteIdx_;
+    if (index_.IsFull(currentWriteIdx, readIdxCached_)) {
+      RefreshReadIdx();
+      if (index_.IsFull(currentWriteIdx, readIdxCached_)) {
+        // the consumer may be waiting for elements that are still unpublished
+        producerStats_.PushFull();
+        Flush();
+        return false;
+      }
+    }
+
+    PrefetchForWrite(currentWriteIdx);
+    construct(index_.Slot(currentWriteIdx));
+    localWriteIdx_ = index_.Next(currentWriteIdx);
+    PublishWrites(1);
+    return true;
+  }
+
+  // Prefetches the element `consumerPrefetch_` past `readIdx` when it is known to be published.
+  // A slot the producer may still be writing is left alone, reading it early would only make its
+  // lines bounce.
+  void PrefetchForRead(size_t readIdx) const {
+    if (consumerPrefetch_ != 0 && consumerPrefetch_ < index_.Size(writeIdxCached_, readIdx)) {
+      data_.template Prefetch<false>(index_.Slot(index_.Advance(readIdx, consumerPrefetch_)));
+    }
+  }
+
+  // Prefetches the slot `producerPrefetch_` past `writeIdx` for writing when it is known to be
+  // free, so a slot the consumer may still be reading is never taken from it
+  void PrefetchForWrite(size_t writeIdx) const {
+    if (producerPrefetch_ != 0 &&
+        producerPrefetch_ < index_.Capacity() - index_.Size(writeIdx, readIdxCached_)) {
+      data_.template Prefetch<true>(index_.Slot(index_.Advance(writeIdx, producerPrefetch_)));
+    }
+  }
+
+  void RefreshReadIdx() {
+    readIdxCached_ = readIdx_.load(std::memory_order_acquire);
+    producerStats_.ReadIdxRefresh();
+  }
+
+  void RefreshWriteIdx(size_t readIdx) {
+    writeIdxCached_ = writeIdx_.load(std::memory_order_acquire);
+    consumerStats_.WriteIdxRefresh(index_.Size(writeIdxCached_, readIdx));
+  }
+
+  void PublishWrites(size_t count) {
+    unpublishedWrites_ += count;
+    if (unpublishedWrites_ >= producerBatch_) {
+      Flush();
+    }
+  }
+
+  void PublishReads(size_t count) {
+    unpublishedReads_ += count;
+    if (unpublishedReads_ >= consumerBatch_) {
+      FlushConsumed();
+    }
+  }
+
+  // read-only after construction, shared by both sides. No space at all for an index that only
+  // holds constants.
+  [[no_unique_address]] Index index_;
+  Storage data_;
+  const size_t producerBatch_;
+  const size_t consumerBatch_;
+  const size_t producerPrefetch_;
+  const size_t consumerPrefetch_;
   alignas(os::kL1CacheLineSize) std::atomic<size_t> readIdx_{0};
+  // owned by the consumer, readIdx_ lags localReadIdx_ by unpublishedReads_ elements
   alignas(os::kL1CacheLineSize) size_t writeIdxCached_{0};
+  size_t localReadIdx_{0};
+  size_t unpublishedReads_{0};
+  // on lines of their own for CountingStats, no space at all for NoStats
+  [[no_unique_address]] typename StatsPolicy::Consumer consumerStats_;
   alignas(os::kL1CacheLineSize) std::atomic<size_t> writeIdx_{0};
+  // owned by the producer, writeIdx_ lags localWriteIdx_ by unpublishedWrites_ elements
   alignas(os::kL1CacheLineSize) size_t readIdxCached_{0};
+  size_t localWriteIdx_{0};
+  size_t unpublishedWrites_{0};
+  [[no_unique_address]] typename StatsPolicy::Producer producerStats_;
+  // only touched by the Wait* operations
+  detail::Parker producerParker_;
+  detail::Parker consumerParker_;
 };
 
-}  // namespace common::containers
\ No newline at end of file
+template <typename T, CapacityMode Mode = CapacityMode::Modulo, typename StatsPolicy = NoStats>
+using FastRingBuffer =
+  BasicFastRingBuffer<T, detail::RingIndex<Mode>, detail::SlotStorage<T>, StatsPolicy>;
+
+}  // namespace common::containers
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <os/constants.hpp>
+
+namespace common::containers {
+
+// Counters of a ring buffer at one point in time, see CountingStats
+struct RingStats {
+  // Push attempts that found the ring full and pushed nothing, including those inside WaitPush
+  uint64_t pushFull = 0;
+  // Pop attempts that found the ring empty and popped nothing, including those inside WaitPop
+  uint64_t popEmpty = 0;
+  // Times the producer's cached copy of the read index went stale and was reloaded
+  uint64_t readIdxRefreshes = 0;
+  // Times the consumer's cached copy of the write index went stale and was reloaded
+  uint64_t writeIdxRefreshes = 0;
+  // Most elements the consumer found queued right after reloading the write index. The consumer
+  // reloads whenever it has caught up with its cached copy, so this is the largest backlog it
+  // has seen.
+  uint64_t highWater = 0;
+};
+
+namespace detail {
+
+// Counter written by a single thread and read by any. The owner bumps it with a relaxed load and
+// store instead of a locked read-modify-write, readers get a recent value with a relaxed load.
+class StatCounter {
+public:
+  void Add(uint64_t n = 1) {
+    value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  void Max(uint64_t val) {
+    if (val > value_.load(std::memory_order_relaxed)) {
+      value_.store(val, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t Load() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> value_{0};
+};
+
+}  // namespace detail
+
+// Stats policy that counts nothing, the default. The hooks are empty and take no space in the
+// ring, so a ring without stats compiles to the same code as before.
+struct NoStats {
+  struct Producer {
+    void PushFull() {
+    }
+    void ReadIdxRefresh() {
+    }
+    void Snapshot(RingStats&) const {
+    }
+  };
+
+  struct Consumer {
+    void PopEmpty() {
+    }
+    void WriteIdxRefresh(size_t) {
+    }
+    void Snapshot(RingStats&) const {
+    }
+  };
+};
+
+// Stats policy that counts. Each side's counters sit on a cache line of their own, apart from the
+// lines its indices live on, and are only bumped on the slow paths (a full or empty ring, a stale
+// cached index). Any thread may take a snapshot: it only loads the two counter lines, so it never
+// steals a line the hot path writes to. The counters are read one by one, not as a consistent set.
+struct CountingStats {
+  struct alignas(os::kL1CacheLineSize) Producer {
+    void PushFull() {
+      pushFull.Add();
+    }
+    void ReadIdxRefresh() {
+      readIdxRefreshes.Add();
+    }
+    void Snapshot(RingStats& stats) const {
+      stats.pushFull = pushFull.Load();
+      stats.readIdxRefreshes = readIdxRefreshes.Load();
+    }
+
+    detail::StatCounter pushFull;
+    detail::StatCounter readIdxRefreshes;
+  };
+
+  struct alignas(os::kL1CacheLineSize) Consumer {
+    void PopEmpty() {
+      popEmpty.Add();
+    }
+    void WriteIdxRefresh(size_t occupancy) {
+      writeIdxRefreshes.Add();
+      highWater.Max(occupancy);
+    }
+    void Snapshot(RingStats& stats) const {
+      stats.popEmpty = popEmpty.Load();
+      stats.writeIdxRefreshes = writeIdxRefreshes.Load();
+      stats.highWater = highWater.Load();
+    }
+
+    detail::StatCounter popEmpty;
+    detail::StatCounter writeIdxRefreshes;
+    detail::StatCounter highWater;
+  };
+};
+
+}  // namespace common::containers
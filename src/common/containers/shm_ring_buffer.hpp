@@ -0,0 +1,373 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <common/containers/parker.hpp>
+#include <common/containers/ring_buffer.hpp>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <os/constants.hpp>
+#include <os/error.hpp>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace common::containers {
+
+namespace detail {
+
+// Layout of the start of a shared ring mapping. Every process maps the ring at a different
+// address, so the header only holds offsets from its own start, never pointers.
+struct ShmRingHeader {
+  static constexpr uint64_t kMagic = 0x474e4952'4d485321;  // "!SHMRING" in little endian
+  static constexpr uint32_t kVersion = 1;
+
+  // stored last by the creator, an attaching process that sees it sees the rest of the header
+  std::atomic<uint64_t> magic;
+  uint32_t version;
+  uint32_t headerSize;
+  uint64_t elementSize;
+  uint64_t elementAlignment;
+  uint64_t slots;
+  uint64_t dataOffset;
+  uint64_t mappingSize;
+  alignas(os::kL1CacheLineSize) std::atomic<uint64_t> readIdx;
+  alignas(os::kL1CacheLineSize) std::atomic<uint64_t> writeIdx;
+  SharedParker producerParker;
+  SharedParker consumerParker;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                std::atomic<uint32_t>::is_always_lock_free,
+              "atomics in shared memory must not rely on a process-local lock");
+
+}  // namespace detail
+
+// FastRingBuffer for a producer and a consumer living in different processes.
+//
+// The indices, the wait flags and the slots live in one memfd or POSIX shared memory mapping that
+// starts with a versioned header, so both processes work on the same ring without a syscall per
+// message. Elements are copied in and out with memcpy, which is why T has to be trivially copyable
+// and must not hold pointers into either process. Each process keeps its own cached copy of the
+// other side's index. Blocking operations park on non-private futexes, and are only woken by the
+// opposite blocking operation: when one process may block, the other has to use Wait* as well.
+//
+// The creator owns the contents of the ring. Another process attaches with Open, on a descriptor
+// passed over a Unix socket or inherited through fork, or with OpenNamed. Capacity is rounded up
+// to a power of two.
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+class ShmRingBuffer {
+  using Header = detail::ShmRingHeader;
+
+public:
+  // Creates a ring in an anonymous memfd, `name` only shows up in /proc/<pid>/fd
+  static ShmRingBuffer Create(const char* name, size_t capacity) {
+    int fd = ::memfd_create(name, MFD_CLOEXEC);
+    if (fd < 0) {
+      os::ThrowErrno("memfd_create");
+    }
+    return Initialize(fd, capacity);
+  }
+
+  static ShmRingBuffer Create(size_t capacity) {
+    return Create("ring_buffer", capacity);
+  }
+
+  // Creates a ring in the POSIX shared memory object `name`, which must not exist yet
+  static ShmRingBuffer CreateNamed(const char* name, size_t capacity) {
+    int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+      os::ThrowErrno("shm_open");
+    }
+    try {
+      return Initialize(fd, capacity);
+    } catch (...) {
+      // a half initialized object would make every later CreateNamed of the name fail
+      ::shm_unlink(name);
+      throw;
+    }
+  }
+
+  // Attaches to the ring behind `fd`, which stays owned by the caller. Throws when it is not a
+  // ring of T created by a compatible version.
+  static ShmRingBuffer Open(int fd) {
+    int own = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (own < 0) {
+      os::ThrowErrno("fcntl");
+    }
+    return Attach(own);
+  }
+
+  static ShmRingBuffer OpenNamed(const char* name) {
+    int fd = ::shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+      os::ThrowErrno("shm_open");
+    }
+    return Attach(fd);
+  }
+
+  // Removes the name of a ring created with CreateNamed, mappings stay valid
+  static void Unlink(const char* name) {
+    ::shm_unlink(name);
+  }
+
+  ShmRingBuffer(ShmRingBuffer&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)),
+      mapping_(std::exchange(other.mapping_, nullptr)),
+      header_(other.header_),
+      data_(other.data_),
+      index_(other.index_),
+      writeIdxCached_(other.writeIdxCached_),
+      readIdxCached_(other.readIdxCached_) {
+  }
+
+  ShmRingBuffer& operator=(ShmRingBuffer&&) = delete;
+
+  ~ShmRingBuffer() {
+    if (mapping_ != nullptr) {
+      ::munmap(mapping_, header_->mappingSize);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  // Descriptor of the shared mapping, to be handed to the other process
+  int Fd() const {
+    return fd_;
+  }
+
+  bool Push(const T& val) {
+    // can use relaxed due to Modification Ordering guarantee
+    auto const currentWriteIdx = header_->writeIdx.load(std::memory_order_relaxed);
+    if (index_.IsFull(currentWriteIdx, readIdxCached_)) {
+      readIdxCached_ = header_->readIdx.load(std::memory_order_acquire);
+      if (index_.IsFull(currentWriteIdx, readIdxCached_)) {
+        return false;
+      }
+    }
+
+    std::memcpy(data_ + index_.Slot(currentWriteIdx), &val, sizeof(T));
+    header_->writeIdx.store(index_.Next(currentWriteIdx), std::memory_order_release);
+    return true;
+  }
+
+  // Copies as many leading elements of `items` as fit and publishes them with a single store.
+  // Returns the number of elements pushed.
+  size_t PushBulk(std::span<const T> items) {
+    auto const currentWriteIdx = header_->writeIdx.load(std::memory_order_relaxed);
+    if (index_.Capacity() - index_.Size(currentWriteIdx, readIdxCached_) < items.size()) {
+      readIdxCached_ = header_->readIdx.load(std::memory_order_acquire);
+    }
+    const size_t count =
+      std::min(items.size(), index_.Capacity() - index_.Size(currentWriteIdx, readIdxCached_));
+
+    detail::ForEachRun(index_, currentWriteIdx, count, [&](size_t slot, size_t offset, size_t n) {
+      std::memcpy(data_ + slot, items.data() + offset, n * sizeof(T));
+    });
+
+    if (count > 0) {
+      header_->writeIdx.store(index_.Advance(currentWriteIdx, count), std::memory_order_release);
+    }
+    return count;
+  }
+
+  std::optional<T> Pop() {
+    // can use relaxed due to Modification Ordering guarantee
+    auto const readIdx = header_->readIdx.load(std::memory_order_relaxed);
+    if (readIdx == writeIdxCached_) {
+      writeIdxCached_ = header_->writeIdx.load(std::memory_order_acquire);
+      if (readIdx == writeIdxCached_) {
+        return std::nullopt;
+      }
+    }
+
+    std::optional<T> val{data_[index_.Slot(readIdx)]};
+    header_->readIdx.store(index_.Next(readIdx), std::memory_order_release);
+    return val;
+  }
+
+  // Copies up to `max` elements into `out` and releases their slots with a single store.
+  // Returns the number of elements popped.
+  template <std::output_iterator<const T&> OutputIt>
+  size_t PopBulk(OutputIt out, size_t max) {
+    // can use relaxed due to Modification Ordering guarantee
+    auto const readIdx = header_->readIdx.load(std::memory_order_relaxed);
+    if (index_.Size(writeIdxCached_, readIdx) < max) {
+      writeIdxCached_ = header_->writeIdx.load(std::memory_order_acquire);
+    }
+    const size_t count = std::min(max, index_.Size(writeIdxCached_, readIdx));
+
+    detail::ForEachRun(index_, readIdx, count, [&](size_t slot, size_t, size_t n) {
+      out = std::copy_n(data_ + slot, n, out);
+    });
+
+    if (count > 0) {
+      header_->readIdx.store(index_.Advance(readIdx, count), std::memory_order_release);
+    }
+    return count;
+  }
+
+  // Returns up to `max` contiguous elements the consumer can read in place in the shared mapping,
+  // empty when the buffer is empty. The slots are handed back to the producer by Release.
+  std::span<const T> Peek(size_t max = 1) {
+    auto const readIdx = header_->readIdx.load(std::memory_order_relaxed);
+    if (index_.Size(writeIdxCached_, readIdx) < max) {
+      writeIdxCached_ = header_->writeIdx.load(std::memory_order_acquire);
+    }
+    const auto slot = index_.Slot(readIdx);
+    const size_t count =
+      std::min({max, index_.Size(writeIdxCached_, readIdx), index_.Slots() - slot});
+    return {data_ + slot, count};
+  }
+
+  // Hands the first `count` elements returned by the last Peek back to the producer
+  void Release(size_t count) {
+    auto const readIdx = header_->readIdx.load(std::memory_order_relaxed);
+    header_->readIdx.store(index_.Advance(readIdx, count), std::memory_order_release);
+  }
+
+  // Blocking Push: spins for `spinBudget` attempts while the buffer is full, then parks until a
+  // WaitPop in either process frees a slot. Plain Pop does not wake a parked producer.
+  void WaitPush(const T& val, size_t spinBudget = kDefaultSpinBudget) {
+    header_->producerParker.Wait([&] { return Push(val); }, spinBudget);
+    header_->consumerParker.Notify();
+  }
+
+  // Same as WaitPush, but gives up after `timeout`
+  bool WaitPushFor(const T& val, std::chrono::microseconds timeout,
+                   size_t spinBudget = kDefaultSpinBudget) {
+    if (!header_->producerParker.WaitFor([&] { return Push(val); }, timeout, spinBudget)) {
+      return false;
+    }
+    header_->consumerParker.Notify();
+    return true;
+  }
+
+  // Blocking Pop: spins for `spinBudget` attempts while the buffer is empty, then parks until a
+  // WaitPush publishes an element. Plain Push does not wake a parked consumer.
+  T WaitPop(size_t spinBudget = kDefaultSpinBudget) {
+    auto val = header_->consumerParker.Wait([this] { return Pop(); }, spinBudget);
+    header_->producerParker.Notify();
+    return *val;
+  }
+
+  // Same as WaitPop, but returns std::nullopt after `timeout`
+  std::optional<T> WaitPopFor(std::chrono::microseconds timeout,
+                              size_t spinBudget = kDefaultSpinBudget) {
+    auto val = header_->consumerParker.WaitFor([this] { return Pop(); }, timeout, spinBudget);
+    if (val) {
+      header_->producerParker.Notify();
+    }
+    return val;
+  }
+
+  // Maximum number of elements the buffer can hold at once
+  size_t Capacity() const {
+    return index_.Capacity();
+  }
+
+private:
+  static constexpr size_t kDataAlignment = std::max(alignof(T), os::kL1CacheLineSize);
+
+  ShmRingBuffer(int fd, void* mapping)
+    : fd_(fd),
+      mapping_(mapping),
+      header_(static_cast<Header*>(mapping)),
+      data_(reinterpret_cast<T*>(static_cast<std::byte*>(mapping) + header_->dataOffset)),
+      index_(header_->slots),
+      writeIdxCached_(header_->readIdx.load(std::memory_order_acquire)),
+      readIdxCached_(writeIdxCached_) {
+  }
+
+  // Sizes the file behind `fd` for `capacity` elements and writes the header
+  static ShmRingBuffer Initialize(int fd, size_t capacity) {
+    const size_t slots = std::bit_ceil(std::max<size_t>(capacity, 1));
+    const size_t dataOffset =
+      (sizeof(Header) + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+    const size_t mappingSize = dataOffset + slots * sizeof(T);
+
+    if (::ftruncate(fd, static_cast<off_t>(mappingSize)) != 0) {
+      os::ThrowErrno("ftruncate", fd);
+    }
+    void* mapping = Map(fd, mappingSize);
+
+    auto* header = ::new (mapping) Header{};
+    header->version = Header::kVersion;
+    header->headerSize = sizeof(Header);
+    header->elementSize = sizeof(T);
+    header->elementAlignment = alignof(T);
+    header->slots = slots;
+    header->dataOffset = dataOffset;
+    header->mappingSize = mappingSize;
+    header->magic.store(Header::kMagic, std::memory_order_release);
+    return ShmRingBuffer(fd, mapping);
+  }
+
+  // Maps the ring behind `fd` and checks that its header describes a ring of T
+  static ShmRingBuffer Attach(int fd) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      os::ThrowErrno("fstat", fd);
+    }
+    const auto fileSize = static_cast<size_t>(st.st_size);
+    if (fileSize < sizeof(Header)) {
+      ::close(fd);
+      throw std::runtime_error("ShmRingBuffer: mapping is too small for a ring header");
+    }
+    void* mapping = Map(fd, fileSize);
+
+    const auto* header = static_cast<const Header*>(mapping);
+    const char* error = nullptr;
+    if (header->magic.load(std::memory_order_acquire) != Header::kMagic) {
+      error = "ShmRingBuffer: mapping does not hold an initialized ring";
+    } else if (header->version != Header::kVersion || header->headerSize != sizeof(Header)) {
+      error = "ShmRingBuffer: ring was created by an incompatible version";
+    } else if (header->elementSize != sizeof(T) || header->elementAlignment != alignof(T)) {
+      error = "ShmRingBuffer: ring holds elements of a different type";
+    } else if (!std::has_single_bit(header->slots) || header->mappingSize != fileSize ||
+               header->dataOffset % kDataAlignment != 0 ||
+               header->dataOffset + header->slots * sizeof(T) > fileSize) {
+      error = "ShmRingBuffer: ring header is corrupted";
+    }
+    if (error != nullptr) {
+      ::munmap(mapping, fileSize);
+      ::close(fd);
+      throw std::runtime_error(error);
+    }
+    return ShmRingBuffer(fd, mapping);
+  }
+
+  static void* Map(int fd, size_t size) {
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      os::ThrowErrno("mmap", fd);
+    }
+    return mapping;
+  }
+
+  int fd_;
+  void* mapping_;
+  // both point into the mapping, at the addresses this process sees it at
+  Header* header_;
+  T* data_;
+  detail::RingIndex<CapacityMode::PowerOfTwo> index_;
+  // process-local, only the consumer's and the producer's copy respectively are ever used. Both
+  // start at the ring's read index, which is a lower bound for either side, so a process that
+  // attaches after traffic reloads them before trusting them.
+  size_t writeIdxCached_;
+  size_t readIdxCached_;
+};
+
+}  // namespace common::containers
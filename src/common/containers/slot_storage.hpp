@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <os/constants.hpp>
+#include <os/memory/numa.hpp>
+#include <os/memory/pages.hpp>
+#include <utility>
+
+namespace common::containers {
+
+// How the slots of a ring are backed
+struct StorageOptions {
+  // Map the slots with huge pages instead of allocating them on the heap, so that a large ring
+  // needs a handful of TLB entries instead of one per 4 KB. Uses MAP_HUGETLB when huge pages are
+  // reserved and transparent huge pages otherwise.
+  bool hugePages = false;
+  // Fault every page in at construction, so the hot path never takes a page fault
+  bool prefault = false;
+  // Bind the slots to this NUMA node, typically the consumer's: os::memory::NodeOfCpu(cpu), or
+  // os::memory::CurrentNode() on the consumer thread. The slots then get their own mapping, since
+  // heap pages may already have been faulted in on another node.
+  int numaNode = os::memory::kAnyNode;
+};
+
+namespace detail {
+
+// Preallocated, uninitialized storage for ring buffer slots.
+// Objects are constructed and destroyed in place by the owning container, which is the only one
+// that knows which slots are alive. The block starts on its own cache line so it does not share
+// one with unrelated heap data.
+template <typename T>
+class SlotStorage {
+  static constexpr std::align_val_t kAlignment{std::max(alignof(T), os::kL1CacheLineSize)};
+
+public:
+  explicit SlotStorage(size_t slots, StorageOptions options = {}) {
+    const bool bind = options.numaNode != os::memory::kAnyNode;
+    if (options.hugePages) {
+      // pages must not be faulted in before they are bound
+      mapping_ = os::memory::MapHuge(slots * sizeof(T), options.prefault && !bind);
+    } else if (bind) {
+      mapping_ = os::memory::MapRegular(slots * sizeof(T));
+    }
+    slots_ = static_cast<T*>(mapping_.data);
+    if (bind && slots_ != nullptr) {
+      if (os::memory::BindToNode(mapping_.data, mapping_.bytes, options.numaNode)) {
+        node_ = options.numaNode;
+      }
+      if (options.prefault) {
+        os::memory::Prefault(mapping_.data, mapping_.bytes);
+      }
+    }
+    if (slots_ == nullptr) {
+      slots_ = static_cast<T*>(::operator new(slots * sizeof(T), kAlignment));
+      if (options.prefault) {
+        os::memory::Prefault(slots_, slots * sizeof(T));
+      }
+    }
+  }
+
+  // Non-copyable
+  SlotStorage(const SlotStorage&) = delete;
+  SlotStorage& operator=(const SlotStorage&) = delete;
+
+  // Non-movable
+  SlotStorage(SlotStorage&&) = delete;
+  SlotStorage& operator=(SlotStorage&&) = delete;
+
+  ~SlotStorage() {
+    if (mapping_.data != nullptr) {
+      os::memory::Unmap(mapping_);
+    } else {
+      ::operator delete(slots_, kAlignment);
+    }
+  }
+
+  // What backs the slots, huge page requests fall back to regular pages when neither kind of
+  // huge page is available
+  os::memory::PageBacking Backing() const {
+    return mapping_.backing;
+  }
+
+  // NUMA node the slots are bound to, kAnyNode when they were not bound or binding failed
+  int Node() const {
+    return node_;
+  }
+
+  T* Data() const {
+    return slots_;
+  }
+
+  T& operator[](size_t slot) const {
+    return slots_[slot];
+  }
+
+  template <typename... Args>
+  void Construct(size_t slot, Args&&... args) {
+    std::construct_at(slots_ + slot, std::forward<Args>(args)...);
+  }
+
+  // Constructs the slot from the prvalue returned by `factory`, which is elided into place
+  template <typename Factory>
+  void ConstructWith(size_t slot, Factory&& factory) {
+    ::new (static_cast<void*>(slots_ + slot)) T(std::forward<Factory>(factory)());
+  }
+
+  void Destroy(size_t slot, size_t count = 1) {
+    std::destroy_n(slots_ + slot, count);
+  }
+
+  // Hints the CPU to pull every cache line of `slot` in ahead of use, in exclusive state when
+  // `ForWrite` so the store that follows does not need another round trip
+  template <bool ForWrite>
+  void Prefetch(size_t slot) const {
+    auto const* bytes = reinterpret_cast<const char*>(slots_ + slot);
+    for (size_t offset = 0; offset < sizeof(T); offset += os::kL1CacheLineSize) {
+      __builtin_prefetch(bytes + offset, ForWrite ? 1 : 0, 3);
+    }
+  }
+
+private:
+  T* slots_ = nullptr;
+  // set when the slots are mapped rather than allocated on the heap
+  os::memory::Mapping mapping_;
+  int node_ = os::memory::kAnyNode;
+};
+
+// SlotStorage for a slot count known at compile time, held inline in the owning container
+// instead of behind a pointer. Same interface, minus the page backing options.
+//
+// The elements are created by placement new in a byte array, so a pointer derived from the array
+// only reaches them through std::launder, and only while they are alive. Data() is the raw slot
+// memory for constructing into, element accesses go through operator[].
+template <typename T, size_t Slots>
+class InlineSlotStorage {
+public:
+  // The slot count is part of the type, and inline slots have no pages of their own to back, bind
+  // or prefault, so both arguments only mirror SlotStorage
+  explicit InlineSlotStorage(size_t /* slots */ = Slots, StorageOptions /* options */ = {}) {
+  }
+
+  InlineSlotStorage(const InlineSlotStorage&) = delete;
+  InlineSlotStorage& operator=(const InlineSlotStorage&) = delete;
+
+  T* Data() {
+    return reinterpret_cast<T*>(storage_);
+  }
+
+  // `slot` must hold a live element
+  T& operator[](size_t slot) {
+    return *std::launder(Data() + slot);
+  }
+
+  template <typename... Args>
+  void Construct(size_t slot, Args&&... args) {
+    std::construct_at(Data() + slot, std::forward<Args>(args)...);
+  }
+
+  // Constructs the slot from the prvalue returned by `factory`, which is elided into place
+  template <typename Factory>
+  void ConstructWith(size_t slot, Factory&& factory) {
+    ::new (static_cast<void*>(Data() + slot)) T(std::forward<Factory>(factory)());
+  }
+
+  void Destroy(size_t slot, size_t count = 1) {
+    if (count > 0) {
+      std::destroy_n(&(*this)[slot], count);
+    }
+  }
+
+  template <bool ForWrite>
+  void Prefetch(size_t slot) const {
+    auto const* bytes = storage_ + slot * sizeof(T);
+    for (size_t offset = 0; offset < sizeof(T); offset += os::kL1CacheLineSize) {
+      __builtin_prefetch(bytes + offset, ForWrite ? 1 : 0, 3);
+    }
+  }
+
+private:
+  alignas(std::max(alignof(T), os::kL1CacheLineSize)) std::byte storage_[Slots * sizeof(T)];
+};
+
+// Slot of a sequence-numbered ring: `seq` tells whose turn it is to touch `storage`.
+// Padded to a cache line so threads working on neighbouring slots do not false share.
+template <typename T>
+struct alignas(os::kL1CacheLineSize) SequencedSlot {
+  std::atomic<size_t> seq;
+  // published instead of an element when its constructor threw, so the consumer steps over the
+  // slot rather than waiting for it forever. Ordered by `seq` like the element itself.
+  bool skip = false;
+  alignas(T) std::byte storage[sizeof(T)];
+
+  T* Get() {
+    return std::launder(reinterpret_cast<T*>(storage));
+  }
+};
+
+// Allocates `slots` sequenced slots with every sequence set to the slot's position, i.e. free for
+// the first lap
+template <typename T>
+std::unique_ptr<SequencedSlot<T>[]> MakeSequencedSlots(size_t slots) {
+  auto result = std::make_unique<SequencedSlot<T>[]>(slots);
+  for (size_t i = 0; i < slots; ++i) {
+    result[i].seq.store(i, std::memory_order_relaxed);
+  }
+  return result;
+}
+
+}  // namespace detail
+
+}  // namespace common::containers
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <os/constants.hpp>
+#include <utility>
+
+namespace common::containers {
+
+// Wait-free single writer single reader publication of the latest value.
+//
+// Three copies of T: the writer fills the back one, the reader looks at the front one and the
+// third sits in the middle, holding the newest published value the reader has not taken yet.
+// Publishing swaps the back copy with the middle one and taking the newest swaps the middle copy
+// with the front one, each a single exchange on a shared index, so neither side ever waits for
+// the other or copies under a lock. The reader only sees complete values and skips every value
+// that was superseded before it looked.
+template <typename T>
+class TripleBuffer {
+  // set in middle_ when it holds a value the reader has not taken yet
+  static constexpr uint8_t kFresh = 0b100;
+  static constexpr uint8_t kIndexMask = 0b011;
+
+  struct alignas(os::kL1CacheLineSize) Copy {
+    T value;
+  };
+
+public:
+  // All three copies start out as T(args...), which is what Front() returns before the first
+  // Publish
+  template <typename... Args>
+  explicit TripleBuffer(const Args&... args)
+    : copies_{Copy{T(args...)}, Copy{T(args...)}, Copy{T(args...)}} {
+  }
+
+  // Writer side. The copy to fill before the next Publish. It holds whatever was published a
+  // couple of rounds ago, not the last value, so overwrite all of it.
+  T& Back() {
+    return copies_[back_].value;
+  }
+
+  // Writer side. Makes the back copy the newest value and takes another one to write into.
+  void Publish() {
+    // acq_rel: releases the back copy and acquires the copy the reader may have just given up
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+  }
+
+  // Writer side. Copies `val` into the back copy and publishes it.
+  template <typename U>
+  void Write(U&& val) {
+    Back() = std::forward<U>(val);
+    Publish();
+  }
+
+  // Reader side. Takes the newest published value, if there is one the reader has not seen yet.
+  // Returns whether Front() changed.
+  bool Update() {
+    if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+
+  // Reader side. The value taken by the last Update, stays valid and unchanged until the next one.
+  const T& Front() const {
+    return copies_[front_].value;
+  }
+
+  // Reader side. Update, then Front.
+  const T& Read() {
+    Update();
+    return Front();
+  }
+
+private:
+  std::array<Copy, 3> copies_;
+  // shared, index of the middle copy plus kFresh
+  alignas(os::kL1CacheLineSize) std::atomic<uint8_t> middle_{1};
+  // owned by the writer
+  alignas(os::kL1CacheLineSize) uint8_t back_{0};
+  // owned by the reader
+  alignas(os::kL1CacheLineSize) uint8_t front_{2};
+};
+
+}  // namespace common::containers
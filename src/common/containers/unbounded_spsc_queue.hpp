@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <common/containers/ring_buffer.hpp>
+#include <common/containers/slot_storage.hpp>
+#include <cstddef>
+#include <optional>
+#include <os/constants.hpp>
+#include <utility>
+
+namespace common::containers {
+
+// Unbounded Single Producer Single Consumer queue made of fixed-size segments linked together.
+//
+// The producer fills the tail segment and links a new one when it is full. The consumer drains
+// the head segment and moves on once the producer has linked the next one. Drained segments go
+// back to the producer through a bounded SPSC free list, so a steady state allocates nothing.
+// Segments the free list has no room for are deleted, which gives the memory of a burst back.
+template <typename T>
+class UnboundedSPSCQueue {
+  struct Segment {
+    explicit Segment(size_t size) : data(size) {
+    }
+
+    // elements published in this segment, written by the producer only
+    alignas(os::kL1CacheLineSize) std::atomic<size_t> written{0};
+    std::atomic<Segment*> next{nullptr};
+    alignas(os::kL1CacheLineSize) detail::SlotStorage<T> data;
+  };
+
+public:
+  // `segmentSize` elements per segment, at least one, at most `maxSpareSegments` drained segments
+  // are kept around for reuse
+  explicit UnboundedSPSCQueue(size_t segmentSize = 1024, size_t maxSpareSegments = 4)
+    : segmentSize_(std::max<size_t>(segmentSize, 1)),
+      spareSegments_(maxSpareSegments + 1),
+      head_(new Segment(segmentSize_)),
+      tail_(head_) {
+    allocated_.store(1, std::memory_order_relaxed);
+  }
+
+  ~UnboundedSPSCQueue() {
+    for (Segment* segment = head_; segment != nullptr;) {
+      auto const written = segment->written.load(std::memory_order_relaxed);
+      segment->data.Destroy(headPos_, written - headPos_);
+      headPos_ = 0;
+      delete std::exchange(segment, segment->next.load(std::memory_order_relaxed));
+    }
+    while (auto spare = spareSegments_.Pop()) {
+      delete *spare;
+    }
+  }
+
+  void Push(T val) {
+    Emplace(std::move(val));
+  }
+
+  // Constructs the element directly in its slot. Never fails, a full tail segment is followed by a
+  // recycled or a newly allocated one.
+  template <typename... Args>
+  void Emplace(Args&&... args) {
+    if (tailPos_ == segmentSize_) {
+      LinkSegment();
+    }
+    tail_->data.Construct(tailPos_, std::forward<Args>(args)...);
+    tail_->written.store(++tailPos_, std::memory_order_release);
+  }
+
+  std::optional<T> Pop() {
+    if (headPos_ == writtenCached_ && !Refresh()) {
+      return std::nullopt;
+    }
+
+    std::optional<T> val{std::move(head_->data[headPos_])};
+    head_->data.Destroy(headPos_);
+    ++headPos_;
+    return val;
+  }
+
+  // Number of segments currently allocated, spare ones included. Only exact while neither side
+  // is running.
+  size_t Segments() const {
+    return allocated_.load(std::memory_order_relaxed) - freed_.load(std::memory_order_relaxed);
+  }
+
+private:
+  // Called by the producer when the tail segment is full
+  void LinkSegment() {
+    Segment* segment;
+    if (auto spare = spareSegments_.Pop()) {
+      // the consumer is done with it, the free list handed it over with acquire/release
+      segment = *spare;
+      segment->written.store(0, std::memory_order_relaxed);
+      segment->next.store(nullptr, std::memory_order_relaxed);
+    } else {
+      segment = new Segment(segmentSize_);
+      allocated_.store(allocated_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    tail_->next.store(segment, std::memory_order_release);
+    tail_ = segment;
+    tailPos_ = 0;
+  }
+
+  // Called by the consumer once it has caught up with the last known producer position. Moves on
+  // to the next segment when the head one is drained. Returns whether there is an element to pop.
+  bool Refresh() {
+    writtenCached_ = head_->written.load(std::memory_order_acquire);
+    if (headPos_ != writtenCached_) {
+      return true;
+    }
+    if (headPos_ != segmentSize_) {
+      return false;
+    }
+    // every element of a full segment was published before the next one was linked
+    Segment* next = head_->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    Recycle(std::exchange(head_, next));
+    headPos_ = 0;
+    writtenCached_ = head_->written.load(std::memory_order_acquire);
+    return writtenCached_ != 0;
+  }
+
+  // Called by the consumer on a drained segment
+  void Recycle(Segment* segment) {
+    if (!spareSegments_.Push(segment)) {
+      delete segment;
+      freed_.store(freed_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+  }
+
+  // read-only after construction, shared by both sides
+  alignas(os::kL1CacheLineSize) const size_t segmentSize_;
+  // drained segments on their way back from the consumer to the producer
+  FastRingBuffer<Segment*> spareSegments_;
+  // owned by the consumer
+  alignas(os::kL1CacheLineSize) Segment* head_;
+  size_t headPos_{0};
+  size_t writtenCached_{0};
+  std::atomic<size_t> freed_{0};
+  // owned by the producer
+  alignas(os::kL1CacheLineSize) Segment* tail_;
+  size_t tailPos_{0};
+  std::atomic<size_t> allocated_{0};
+};
+
+}  // namespace common::containers
@@ -7,5 +7,11 @@ namespace os {
 // Typical L1 cache line size for x86/x86_64 architectures
 constexpr size_t kL1CacheLineSize = 64;
 
+// Base page size on x86_64
+constexpr size_t kPageSize = 4096;
+
+// Default huge page size on x86_64, one PMD entry
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
 }  // namespace os
 
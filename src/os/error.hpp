@@ -0,0 +1,19 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+
+namespace os {
+
+// Closes `fd`, if any, and reports the errno of the call that failed
+[[noreturn]] inline void ThrowErrno(const char* what, int fd = -1) {
+  const int error = errno;
+  if (fd >= 0) {
+    ::close(fd);
+  }
+  throw std::system_error(error, std::generic_category(), what);
+}
+
+}  // namespace os
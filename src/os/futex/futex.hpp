@@ -1,8 +1,12 @@
+#pragma once
+
 #include <linux/futex.h>
 #include <sys/syscall.h>
 #include <time.h>
 #include <unistd.h>
 
+#include <cstdint>
+
 namespace os::futex {
 
 inline void SetTimeout(struct timespec& timeout, uint32_t micros) {
@@ -29,4 +33,27 @@ inline int WakeAll(uint32_t* loc) {
   return syscall(SYS_futex, loc, FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
 }
 
+// Shared variants for futex words in memory mapped by several processes (memfd, shm_open).
+// The private operations above key the futex on the calling process's address space, so they
+// never wake a waiter in another process.
+
+inline int WaitTimedShared(uint32_t* loc, uint32_t old, uint32_t micros) {
+  struct timespec timeout;
+  SetTimeout(timeout, micros);
+
+  return syscall(SYS_futex, loc, FUTEX_WAIT, old, &timeout, nullptr, 0);
+}
+
+inline int WaitShared(uint32_t* loc, uint32_t old) {
+  return syscall(SYS_futex, loc, FUTEX_WAIT, old, nullptr, nullptr, 0);
+}
+
+inline int WakeOneShared(uint32_t* loc) {
+  return syscall(SYS_futex, loc, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+inline int WakeAllShared(uint32_t* loc) {
+  return syscall(SYS_futex, loc, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
 }  // namespace os::futex
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <climits>
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+// NUMA placement through the raw syscalls, without a libnuma dependency
+
+namespace os::memory {
+
+// No particular NUMA node
+inline constexpr int kAnyNode = -1;
+
+// NUMA node of the CPU the calling thread is running on, kAnyNode when unknown
+inline int CurrentNode() {
+  unsigned cpu = 0;
+  unsigned node = 0;
+  if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+    return kAnyNode;
+  }
+  return static_cast<int>(node);
+}
+
+// NUMA node CPU `cpu` belongs to, kAnyNode when unknown. Lets a ring be placed on the node of a
+// consumer that will be pinned to `cpu` before that thread exists.
+inline int NodeOfCpu(int cpu) {
+  std::error_code error;
+  const std::filesystem::path dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+  // a range-for would advance with operator++, which throws on a read error
+  for (std::filesystem::directory_iterator it(dir, error), end; !error && it != end;
+       it.increment(error)) {
+    const auto name = it->path().filename().string();
+    int node = 0;
+    if (name.starts_with("node") &&
+        std::from_chars(name.data() + 4, name.data() + name.size(), node).ec == std::errc{}) {
+      return node;
+    }
+  }
+  return kAnyNode;
+}
+
+// Binds the pages of [data, data + bytes), which must be page aligned, to `node`. Pages faulted in
+// afterwards are allocated there and pages already faulted in are migrated. Returns false when
+// the kernel refuses, e.g. when it is built without NUMA support or the node does not exist.
+inline bool BindToNode(void* data, size_t bytes, int node) {
+  constexpr size_t kMaxNodes = 1024;
+  constexpr size_t kBitsPerWord = sizeof(unsigned long) * CHAR_BIT;
+  if (node < 0 || static_cast<size_t>(node) >= kMaxNodes) {
+    return false;
+  }
+
+  unsigned long nodeMask[kMaxNodes / kBitsPerWord] = {};
+  nodeMask[node / kBitsPerWord] = 1UL << (node % kBitsPerWord);
+  return ::syscall(SYS_mbind, data, bytes, MPOL_BIND, nodeMask, kMaxNodes, MPOL_MF_MOVE) == 0;
+}
+
+}  // namespace os::memory
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <os/constants.hpp>
+
+namespace os::memory {
+
+// What actually backs a mapping
+enum class PageBacking {
+  // base pages
+  Regular,
+  // base pages the kernel is asked to collapse into huge pages (MADV_HUGEPAGE)
+  Transparent,
+  // huge pages reserved up front through /proc/sys/vm/nr_hugepages (MAP_HUGETLB)
+  HugeTlb,
+};
+
+struct Mapping {
+  void* data = nullptr;
+  size_t bytes = 0;
+  PageBacking backing = PageBacking::Regular;
+};
+
+inline size_t RoundUp(size_t bytes, size_t alignment) {
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+// Faults every page of [data, data + bytes) in for writing. `data` need not be page aligned, heap
+// blocks usually are not. The contents are not preserved: the block must not hold data yet.
+inline void Prefault(void* data, size_t bytes) {
+  if (bytes == 0) {
+    return;
+  }
+#ifdef MADV_POPULATE_WRITE
+  // madvise wants a page aligned start, populating leaves the contents of the page untouched
+  auto const begin = reinterpret_cast<uintptr_t>(data) / kPageSize * kPageSize;
+  auto const end = reinterpret_cast<uintptr_t>(data) + bytes;
+  if (::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_POPULATE_WRITE) == 0) {
+    return;
+  }
+#endif
+  // kernels before 5.14, touching one byte per base page is enough. Steps of kPageSize from an
+  // unaligned start can step over the last page, so its last byte is touched as well.
+  auto* bytePtr = static_cast<volatile std::byte*>(data);
+  for (size_t offset = 0; offset < bytes; offset += kPageSize) {
+    bytePtr[offset] = std::byte{0};
+  }
+  bytePtr[bytes - 1] = std::byte{0};
+}
+
+// Maps `bytes` of anonymous memory, rounded up to whole huge pages. Uses MAP_HUGETLB when enough
+// huge pages are reserved, and a huge page aligned regular mapping with MADV_HUGEPAGE otherwise.
+// With `prefault` every page is faulted in before returning, so later accesses never take a page
+// fault. Returns a Mapping with null data on failure.
+inline Mapping MapHuge(size_t bytes, bool prefault) {
+  bytes = RoundUp(bytes, kHugePageSize);
+
+  const int populate = prefault ? MAP_POPULATE : 0;
+  void* data = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+  if (data != MAP_FAILED) {
+    return {data, bytes, PageBacking::HugeTlb};
+  }
+
+  // transparent huge pages only back huge page aligned ranges, over-allocate and trim
+  void* raw = ::mmap(nullptr, bytes + kHugePageSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    return {};
+  }
+  auto const begin = reinterpret_cast<uintptr_t>(raw);
+  auto const aligned = RoundUp(begin, kHugePageSize);
+  if (aligned > begin) {
+    ::munmap(raw, aligned - begin);
+  }
+  if (auto const tail = begin + kHugePageSize - aligned; tail > 0) {
+    ::munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+  }
+
+  data = reinterpret_cast<void*>(aligned);
+  auto const backing =
+    ::madvise(data, bytes, MADV_HUGEPAGE) == 0 ? PageBacking::Transparent : PageBacking::Regular;
+  // MAP_POPULATE would fault the range in before the advice, with base pages
+  if (prefault) {
+    Prefault(data, bytes);
+  }
+  return {data, bytes, backing};
+}
+
+// Maps `bytes` of anonymous memory, rounded up to whole base pages, without faulting it in. Unlike
+// a heap block the range shares no page with other data, so it can be placed with BindToNode
+// before it is touched. Returns a Mapping with null data on failure.
+inline Mapping MapRegular(size_t bytes) {
+  bytes = RoundUp(bytes, kPageSize);
+  void* data =
+    ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED) {
+    return {};
+  }
+  return {data, bytes, PageBacking::Regular};
+}
+
+inline void Unmap(const Mapping& mapping) {
+  if (mapping.data != nullptr) {
+    ::munmap(mapping.data, mapping.bytes);
+  }
+}
+
+}  // namespace os::memory
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <common/containers/byte_ring_buffer.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <thread>
+#include <vector>
+
+using common::containers::ByteRingBuffer;
+
+namespace {
+
+// Record of `size` bytes whose content is derived from `seed`
+std::vector<std::byte> MakeRecord(size_t size, uint8_t seed) {
+  std::vector<std::byte> record(size);
+  for (size_t i = 0; i < size; ++i) {
+    record[i] = static_cast<std::byte>(seed + i);
+  }
+  return record;
+}
+
+bool Equal(std::span<const std::byte> lhs, std::span<const std::byte> rhs) {
+  return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+}  // namespace
+
+class ByteRingBufferTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+  }
+
+  void TearDown() override {
+  }
+};
+
+TEST_F(ByteRingBufferTest, BasicPushPeekRelease) {
+  ByteRingBuffer buffer(256);
+  auto record = MakeRecord(13, 1);
+
+  EXPECT_TRUE(buffer.Peek().empty());
+  ASSERT_TRUE(buffer.Push(record));
+
+  auto peeked = buffer.Peek();
+  EXPECT_TRUE(Equal(peeked, record));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(peeked.data()) % 8, 0u);
+  buffer.Release();
+  EXPECT_TRUE(buffer.Peek().empty());
+}
+
+TEST_F(ByteRingBufferTest, CapacityRoundsUp) {
+  ByteRingBuffer buffer(1000);
+
+  EXPECT_EQ(buffer.Capacity(), 1024u);
+  EXPECT_EQ(buffer.MaxRecordSize(), 504u);
+}
+
+TEST_F(ByteRingBufferTest, MixedSizesKeepOrder) {
+  ByteRingBuffer buffer(1024);
+  const std::vector<size_t> sizes = {1, 16, 7, 100, 0, 64, 33};
+
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    ASSERT_TRUE(buffer.Push(MakeRecord(sizes[i], i)));
+  }
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    auto peeked = buffer.Peek();
+    ASSERT_EQ(peeked.size(), sizes[i]);
+    EXPECT_NE(peeked.data(), nullptr);
+    EXPECT_TRUE(Equal(peeked, MakeRecord(sizes[i], i)));
+    buffer.Release();
+  }
+  EXPECT_TRUE(buffer.Peek().empty());
+}
+
+TEST_F(ByteRingBufferTest, PackingDependsOnRecordSize) {
+  ByteRingBuffer buffer(256);
+
+  // 8 byte header + 8 byte payload per record
+  size_t pushed = 0;
+  while (buffer.Push(MakeRecord(8, 0))) {
+    ++pushed;
+  }
+  EXPECT_EQ(pushed, 16u);
+}
+
+TEST_F(ByteRingBufferTest, RejectsOversizedRecord) {
+  ByteRingBuffer buffer(256);
+
+  EXPECT_TRUE(buffer.Reserve(buffer.MaxRecordSize() + 1).empty());
+  EXPECT_FALSE(buffer.Push(MakeRecord(buffer.MaxRecordSize() + 1, 0)));
+  EXPECT_TRUE(buffer.Push(MakeRecord(buffer.MaxRecordSize(), 0)));
+}
+
+TEST_F(ByteRingBufferTest, RecordIsNeverSplitAtWrap) {
+  ByteRingBuffer buffer(256);
+
+  // leave 256 - 3 * 64 = 64 bytes before the end, then drain
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(buffer.Push(MakeRecord(56, i)));
+  }
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_FALSE(buffer.Peek().empty());
+    buffer.Release();
+  }
+
+  // 100 bytes do not fit in the remaining 64, the record goes to the start of the storage
+  auto record = MakeRecord(100, 7);
+  auto region = buffer.Reserve(record.size());
+  ASSERT_EQ(region.size(), record.size());
+  std::memcpy(region.data(), record.data(), record.size());
+  buffer.Commit(record.size());
+
+  auto peeked = buffer.Peek();
+  EXPECT_TRUE(Equal(peeked, record));
+  EXPECT_EQ(peeked.data(), static_cast<const std::byte*>(region.data()));
+  buffer.Release();
+  EXPECT_TRUE(buffer.Peek().empty());
+}
+
+TEST_F(ByteRingBufferTest, WrapNeedsRoomForPadding) {
+  ByteRingBuffer buffer(256);
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(buffer.Push(MakeRecord(56, i)));
+  }
+  buffer.Peek();
+  buffer.Release();
+
+  // 64 bytes are free at the start and 64 at the end, but a 120 byte record fits in neither
+  EXPECT_TRUE(buffer.Reserve(112).empty());
+  EXPECT_FALSE(buffer.Reserve(56).empty());
+}
+
+TEST_F(ByteRingBufferTest, CommitLessThanReserved) {
+  ByteRingBuffer buffer(256);
+
+  auto region = buffer.Reserve(100);
+  ASSERT_EQ(region.size(), 100u);
+  std::memcpy(region.data(), "hello", 5);
+  buffer.Commit(5);
+
+  auto peeked = buffer.Peek();
+  ASSERT_EQ(peeked.size(), 5u);
+  EXPECT_EQ(std::memcmp(peeked.data(), "hello", 5), 0);
+  buffer.Release();
+
+  // only the committed size was consumed: 16 bytes per 5 byte record
+  size_t pushed = 0;
+  while (buffer.Push(MakeRecord(5, 0))) {
+    ++pushed;
+  }
+  EXPECT_EQ(pushed, 16u);
+}
+
+TEST_F(ByteRingBufferTest, HighContentionSPSC) {
+  const size_t num_records = 50000;
+  ByteRingBuffer buffer(4096);
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_records; ++i) {
+      auto record = MakeRecord(i % 300, i);
+      while (!buffer.Push(record)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  size_t mismatches = 0;
+  std::thread consumer([&]() {
+    for (size_t i = 0; i < num_records;) {
+      auto peeked = buffer.Peek();
+      if (peeked.data() == nullptr) {
+        std::this_thread::yield();
+        continue;
+      }
+      mismatches += !Equal(peeked, MakeRecord(i % 300, i));
+      buffer.Release();
+      ++i;
+    }
+  });
+
+  producer.join();
+  consumer.join();
+  EXPECT_EQ(mismatches, 0u);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <common/containers/fast_forward_queue.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using common::containers::FastForwardQueue;
+
+class FastForwardQueueTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+  }
+
+  void TearDown() override {
+  }
+};
+
+TEST_F(FastForwardQueueTest, BasicPushPop) {
+  FastForwardQueue<int> queue(8);
+
+  EXPECT_TRUE(queue.Push(42));
+  auto val = queue.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(val.value(), 42);
+}
+
+TEST_F(FastForwardQueueTest, EmptyPop) {
+  FastForwardQueue<int> queue(8);
+
+  EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST_F(FastForwardQueueTest, FillQueue) {
+  FastForwardQueue<int> queue(10, /* batchSize */ 4);
+  ASSERT_EQ(queue.Capacity(), 16u);
+
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_TRUE(queue.Push(i));
+  }
+  EXPECT_FALSE(queue.Push(16));
+
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_EQ(queue.Pop().value(), i);
+  }
+  EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST_F(FastForwardQueueTest, ProbesBacktrackToSingleSlot) {
+  FastForwardQueue<int> queue(64, /* batchSize */ 32);
+
+  // fewer elements than a batch must still get through one by one
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_TRUE(queue.Push(i));
+    ASSERT_EQ(queue.Pop().value(), i);
+    EXPECT_FALSE(queue.Pop().has_value());
+  }
+}
+
+TEST_F(FastForwardQueueTest, ProducerBatchStopsAtUnconsumedSlot) {
+  FastForwardQueue<int> queue(8, /* batchSize */ 8);
+
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_TRUE(queue.Push(i));
+  }
+  EXPECT_EQ(queue.Pop().value(), 0);
+  EXPECT_EQ(queue.Pop().value(), 1);
+
+  // only the two freed slots may be reused
+  EXPECT_TRUE(queue.Push(8));
+  EXPECT_TRUE(queue.Push(9));
+  EXPECT_FALSE(queue.Push(10));
+
+  for (int i = 2; i < 10; ++i) {
+    EXPECT_EQ(queue.Pop().value(), i);
+  }
+}
+
+TEST_F(FastForwardQueueTest, BatchLargerThanCapacity) {
+  FastForwardQueue<int> queue(4, /* batchSize */ 1000);
+
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_TRUE(queue.Push(i));
+    }
+    EXPECT_FALSE(queue.Push(4));
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_EQ(queue.Pop().value(), i);
+    }
+  }
+}
+
+TEST_F(FastForwardQueueTest, MoveOnly) {
+  FastForwardQueue<std::unique_ptr<std::string>> queue(4);
+
+  EXPECT_TRUE(queue.Emplace(std::make_unique<std::string>("hello")));
+  EXPECT_EQ(*queue.Pop().value(), "hello");
+}
+
+TEST_F(FastForwardQueueTest, ElementLifetime) {
+  auto tracked = std::make_shared<int>(0);
+  {
+    FastForwardQueue<std::shared_ptr<int>> queue(8, /* batchSize */ 4);
+    for (int round = 0; round < 3; ++round) {
+      for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.Push(tracked));
+      }
+      queue.Pop();
+      queue.Pop();
+    }
+    EXPECT_EQ(tracked.use_count(), 1 + 6);
+  }
+  EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST_F(FastForwardQueueTest, HighContentionSPSC) {
+  const size_t num_items = 200000;
+  FastForwardQueue<size_t> queue(64, /* batchSize */ 16);
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      while (!queue.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+  std::thread consumer([&]() {
+    while (consumed.size() < num_items) {
+      if (auto val = queue.Pop()) {
+        consumed.push_back(*val);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  for (size_t i = 0; i < num_items; ++i) {
+    ASSERT_EQ(consumed[i], i);
+  }
+  EXPECT_FALSE(queue.Pop().has_value());
+}
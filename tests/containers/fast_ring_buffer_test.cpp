@@ -1,12 +1,33 @@
 #include <gtest/gtest.h>
+#include <sys/mman.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <common/containers/node_local.hpp>
 #include <common/containers/ring_buffer.hpp>
+#include <iterator>
+#include <memory>
 #include <numeric>
+#include <os/constants.hpp>
+#include <os/memory/pages.hpp>
+#include <span>
+#include <string>
 #include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+using common::containers::CapacityMode;
+using common::containers::CopyMode;
+using common::containers::CountingStats;
 using common::containers::FastRingBuffer;
+using common::containers::MakeNodeLocal;
+using common::containers::NoStats;
+using common::containers::PrefetchOptions;
+using common::containers::StorageOptions;
+using os::memory::PageBacking;
 
 class FastRingBufferTest : public ::testing::Test {
 protected:
@@ -281,3 +302,1030 @@ TEST_F(FastRingBufferTest, StressTestWithDelays) {
     EXPECT_EQ(consumed[i], i);
   }
 }
+
+TEST_F(FastRingBufferTest, PowerOfTwoUsesEverySlot) {
+  const size_t capacity = 8;
+  FastRingBuffer<int, CapacityMode::PowerOfTwo> buffer(capacity);
+  EXPECT_EQ(buffer.Capacity(), capacity);
+
+  for (size_t i = 0; i < capacity; ++i) {
+    EXPECT_TRUE(buffer.Push(static_cast<int>(i)));
+  }
+  EXPECT_FALSE(buffer.Push(999));
+
+  for (size_t i = 0; i < capacity; ++i) {
+    auto val = buffer.Pop();
+    ASSERT_TRUE(val.has_value());
+    EXPECT_EQ(val.value(), static_cast<int>(i));
+  }
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(FastRingBufferTest, PowerOfTwoRoundsCapacityUp) {
+  FastRingBuffer<int, CapacityMode::PowerOfTwo> buffer(10);
+  EXPECT_EQ(buffer.Capacity(), 16u);
+
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_TRUE(buffer.Push(i));
+  }
+  EXPECT_FALSE(buffer.Push(999));
+}
+
+TEST_F(FastRingBufferTest, PowerOfTwoWrapAround) {
+  FastRingBuffer<int, CapacityMode::PowerOfTwo> buffer(4);
+
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_TRUE(buffer.Push(round * 10 + i));
+    }
+    for (int i = 0; i < 3; ++i) {
+      auto val = buffer.Pop();
+      ASSERT_TRUE(val.has_value());
+      EXPECT_EQ(val.value(), round * 10 + i);
+    }
+  }
+}
+
+TEST_F(FastRingBufferTest, PowerOfTwoHighContentionSPSC) {
+  const size_t num_items = 50000;
+  const size_t capacity = 16;
+  FastRingBuffer<size_t, CapacityMode::PowerOfTwo> buffer(capacity);
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      while (!buffer.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::thread consumer([&]() {
+    while (consumed.size() < num_items) {
+      auto val = buffer.Pop();
+      if (val.has_value()) {
+        consumed.push_back(val.value());
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  ASSERT_EQ(consumed.size(), num_items);
+  for (size_t i = 0; i < num_items; ++i) {
+    EXPECT_EQ(consumed[i], i);
+  }
+}
+
+TEST_F(FastRingBufferTest, PushBulkPopBulk) {
+  FastRingBuffer<int> buffer(10);
+  std::vector<int> input{1, 2, 3, 4, 5};
+
+  EXPECT_EQ(buffer.PushBulk(std::span(input)), input.size());
+
+  std::vector<int> output;
+  EXPECT_EQ(buffer.PopBulk(std::back_inserter(output), 3), 3u);
+  EXPECT_EQ(output, (std::vector<int>{1, 2, 3}));
+
+  EXPECT_EQ(buffer.PopBulk(std::back_inserter(output), 10), 2u);
+  EXPECT_EQ(output, input);
+  EXPECT_EQ(buffer.PopBulk(std::back_inserter(output), 10), 0u);
+}
+
+TEST_F(FastRingBufferTest, PushBulkStopsWhenFull) {
+  FastRingBuffer<int> buffer(5);
+  std::vector<int> input{1, 2, 3, 4, 5, 6};
+
+  EXPECT_EQ(buffer.PushBulk(std::span(input)), buffer.Capacity());
+  EXPECT_EQ(buffer.PushBulk(std::span(input)), 0u);
+  EXPECT_FALSE(buffer.Push(7));
+
+  int output[4];
+  EXPECT_EQ(buffer.PopBulk(output, 4), 4u);
+  EXPECT_EQ(output[3], 4);
+}
+
+TEST_F(FastRingBufferTest, BulkWrapAround) {
+  FastRingBuffer<int, CapacityMode::PowerOfTwo> buffer(8);
+
+  int next = 0;
+  int expected = 0;
+  for (int round = 0; round < 20; ++round) {
+    std::vector<int> input(5);
+    std::iota(input.begin(), input.end(), next);
+    ASSERT_EQ(buffer.PushBulk(std::span<const int>(input)), input.size());
+    next += 5;
+
+    std::vector<int> output;
+    ASSERT_EQ(buffer.PopBulk(std::back_inserter(output), 5), 5u);
+    for (int val : output) {
+      EXPECT_EQ(val, expected++);
+    }
+  }
+}
+
+TEST_F(FastRingBufferTest, BulkMoveOnly) {
+  FastRingBuffer<std::unique_ptr<int>> buffer(4);
+  std::vector<std::unique_ptr<int>> input;
+  for (int i = 0; i < 3; ++i) {
+    input.push_back(std::make_unique<int>(i));
+  }
+
+  EXPECT_EQ(buffer.PushBulk(std::span(input)), 3u);
+  EXPECT_EQ(input[0], nullptr);
+
+  std::vector<std::unique_ptr<int>> output;
+  EXPECT_EQ(buffer.PopBulk(std::back_inserter(output), 3), 3u);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(*output[i], i);
+  }
+}
+
+TEST_F(FastRingBufferTest, BulkSPSC) {
+  const size_t num_items = 100000;
+  const size_t batch = 7;
+  FastRingBuffer<size_t> buffer(32);
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+
+  std::thread producer([&]() {
+    std::vector<size_t> items(batch);
+    size_t next = 0;
+    while (next < num_items) {
+      const size_t count = std::min(batch, num_items - next);
+      std::iota(items.begin(), items.begin() + count, next);
+      size_t pushed = 0;
+      while (pushed < count) {
+        pushed += buffer.PushBulk(std::span(items.data() + pushed, count - pushed));
+        std::this_thread::yield();
+      }
+      next += count;
+    }
+  });
+
+  std::thread consumer([&]() {
+    while (consumed.size() < num_items) {
+      if (buffer.PopBulk(std::back_inserter(consumed), batch) == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  ASSERT_EQ(consumed.size(), num_items);
+  for (size_t i = 0; i < num_items; ++i) {
+    EXPECT_EQ(consumed[i], i);
+  }
+}
+
+TEST_F(FastRingBufferTest, ReserveCommit) {
+  FastRingBuffer<int> buffer(10);
+
+  auto slots = buffer.Reserve(3);
+  ASSERT_EQ(slots.size(), 3u);
+  slots[0] = 1;
+  slots[1] = 2;
+  slots[2] = 3;
+  EXPECT_FALSE(buffer.Pop().has_value());
+
+  buffer.Commit(2);
+  EXPECT_EQ(buffer.Pop().value(), 1);
+  EXPECT_EQ(buffer.Pop().value(), 2);
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(FastRingBufferTest, ReserveWhenFull) {
+  FastRingBuffer<int> buffer(4);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(buffer.Push(i));
+  }
+
+  EXPECT_TRUE(buffer.Reserve().empty());
+  buffer.Pop();
+  EXPECT_EQ(buffer.Reserve(10).size(), 1u);
+}
+
+TEST_F(FastRingBufferTest, PeekRelease) {
+  FastRingBuffer<std::string> buffer(10);
+  EXPECT_TRUE(buffer.Peek().empty());
+
+  buffer.Push("first");
+  buffer.Push("second");
+
+  auto items = buffer.Peek(10);
+  ASSERT_EQ(items.size(), 2u);
+  EXPECT_EQ(items[0], "first");
+  EXPECT_EQ(items[1], "second");
+
+  buffer.Release(1);
+  items = buffer.Peek(10);
+  ASSERT_EQ(items.size(), 1u);
+  EXPECT_EQ(items[0], "second");
+
+  buffer.Release(1);
+  EXPECT_TRUE(buffer.Peek().empty());
+}
+
+TEST_F(FastRingBufferTest, ReservePeekStopAtWrapPoint) {
+  FastRingBuffer<int, CapacityMode::PowerOfTwo> buffer(8);
+  for (int i = 0; i < 6; ++i) {
+    buffer.Push(i);
+  }
+  for (int i = 0; i < 6; ++i) {
+    buffer.Pop();
+  }
+
+  // slots 6 and 7 are contiguous, the rest of the batch starts at slot 0
+  auto slots = buffer.Reserve(5);
+  ASSERT_EQ(slots.size(), 2u);
+  slots[0] = 10;
+  slots[1] = 11;
+  buffer.Commit(slots.size());
+
+  slots = buffer.Reserve(3);
+  ASSERT_EQ(slots.size(), 3u);
+  slots[0] = 12;
+  slots[1] = 13;
+  slots[2] = 14;
+  buffer.Commit(slots.size());
+
+  auto items = buffer.Peek(5);
+  ASSERT_EQ(items.size(), 2u);
+  EXPECT_EQ(items[1], 11);
+  buffer.Release(items.size());
+
+  items = buffer.Peek(5);
+  ASSERT_EQ(items.size(), 3u);
+  EXPECT_EQ(items[2], 14);
+  buffer.Release(items.size());
+}
+
+TEST_F(FastRingBufferTest, ZeroCopySPSC) {
+  const size_t num_items = 100000;
+  FastRingBuffer<size_t> buffer(64);
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+
+  std::thread producer([&]() {
+    size_t next = 0;
+    while (next < num_items) {
+      auto slots = buffer.Reserve(std::min<size_t>(16, num_items - next));
+      for (auto& slot : slots) {
+        slot = next++;
+      }
+      buffer.Commit(slots.size());
+      if (slots.empty()) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::thread consumer([&]() {
+    while (consumed.size() < num_items) {
+      auto items = buffer.Peek(16);
+      consumed.insert(consumed.end(), items.begin(), items.end());
+      buffer.Release(items.size());
+      if (items.empty()) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  ASSERT_EQ(consumed.size(), num_items);
+  for (size_t i = 0; i < num_items; ++i) {
+    EXPECT_EQ(consumed[i], i);
+  }
+}
+
+namespace {
+
+// Counts live instances to check that the buffer constructs and destroys elements in pairs
+struct Tracked {
+  inline static int alive = 0;
+
+  explicit Tracked(int v) : value(v) {
+    ++alive;
+  }
+  Tracked(Tracked&& other) : value(other.value) {
+    ++alive;
+  }
+  ~Tracked() {
+    --alive;
+  }
+
+  int value;
+};
+
+}  // namespace
+
+TEST_F(FastRingBufferTest, ElementLifetime) {
+  {
+    FastRingBuffer<Tracked> buffer(8);
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_TRUE(buffer.Push(Tracked(i)));
+    }
+    EXPECT_EQ(Tracked::alive, 5);
+
+    EXPECT_EQ(buffer.Pop()->value, 0);
+    EXPECT_EQ(Tracked::alive, 4);
+  }
+  // remaining elements are destroyed with the buffer
+  EXPECT_EQ(Tracked::alive, 0);
+
+  {
+    FastRingBuffer<Tracked> buffer(8);
+    for (int i = 0; i < 4; ++i) {
+      std::construct_at(buffer.Reserve().data(), i);
+      buffer.Commit(1);
+    }
+    EXPECT_EQ(Tracked::alive, 4);
+    EXPECT_EQ(buffer.Peek(2).size(), 2u);
+    buffer.Release(2);
+    EXPECT_EQ(Tracked::alive, 2);
+  }
+  EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST_F(FastRingBufferTest, Emplace) {
+  FastRingBuffer<std::pair<int, std::string>> buffer(4);
+
+  EXPECT_TRUE(buffer.Emplace(1, "one"));
+  EXPECT_TRUE(buffer.Emplace(std::piecewise_construct, std::forward_as_tuple(2),
+                             std::forward_as_tuple(3, 'x')));
+
+  auto val = buffer.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(val->first, 1);
+  EXPECT_EQ(val->second, "one");
+  EXPECT_EQ(buffer.Pop()->second, "xxx");
+}
+
+TEST_F(FastRingBufferTest, EmplaceFailsWithoutConstructingWhenFull) {
+  FastRingBuffer<Tracked> buffer(3);
+  EXPECT_TRUE(buffer.Emplace(1));
+  EXPECT_TRUE(buffer.Emplace(2));
+  EXPECT_EQ(Tracked::alive, 2);
+
+  EXPECT_FALSE(buffer.Emplace(3));
+  EXPECT_EQ(Tracked::alive, 2);
+}
+
+TEST_F(FastRingBufferTest, TryEmplaceInvokesFactoryOnlyWhenThereIsRoom) {
+  FastRingBuffer<Tracked> buffer(2);
+  int calls = 0;
+  auto factory = [&calls] {
+    return Tracked(++calls);
+  };
+
+  EXPECT_TRUE(buffer.TryEmplace(factory));
+  EXPECT_FALSE(buffer.TryEmplace(factory));
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(buffer.Pop()->value, 1);
+}
+
+TEST_F(FastRingBufferTest, WaitPopBlocksUntilWaitPush) {
+  FastRingBuffer<int> buffer(4);
+  std::atomic<bool> popped{false};
+
+  std::thread consumer([&]() {
+    EXPECT_EQ(buffer.WaitPop(/* spinBudget */ 0), 42);
+    popped.store(true);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(popped.load());
+  buffer.WaitPush(42);
+  consumer.join();
+  EXPECT_TRUE(popped.load());
+}
+
+TEST_F(FastRingBufferTest, WaitForTimesOut) {
+  FastRingBuffer<std::unique_ptr<int>> buffer(2);
+
+  EXPECT_FALSE(buffer.WaitPopFor(std::chrono::milliseconds(5)).has_value());
+
+  // a single usable slot
+  auto first = std::make_unique<int>(1);
+  EXPECT_TRUE(buffer.WaitPushFor(std::move(first), std::chrono::milliseconds(5)));
+
+  auto second = std::make_unique<int>(2);
+  EXPECT_FALSE(buffer.WaitPushFor(std::move(second), std::chrono::milliseconds(5)));
+  // not moved from on timeout
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(*second, 2);
+
+  auto val = buffer.WaitPopFor(std::chrono::milliseconds(5));
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(**val, 1);
+}
+
+TEST_F(FastRingBufferTest, BlockingSPSC) {
+  const size_t num_items = 20000;
+  FastRingBuffer<size_t> buffer(8);
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+
+  // a zero spin budget parks on every miss
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      buffer.WaitPush(i, /* spinBudget */ i % 2 == 0 ? 0 : 16);
+    }
+  });
+
+  std::thread consumer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      consumed.push_back(buffer.WaitPop(/* spinBudget */ i % 3 == 0 ? 0 : 16));
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  ASSERT_EQ(consumed.size(), num_items);
+  for (size_t i = 0; i < num_items; ++i) {
+    EXPECT_EQ(consumed[i], i);
+  }
+}
+
+TEST_F(FastRingBufferTest, ProducerBatchDefersPublication) {
+  FastRingBuffer<int> buffer(16, {}, {.producerBatch = 4});
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(buffer.Push(i));
+  }
+  // the consumer only sees full batches
+  EXPECT_FALSE(buffer.Pop().has_value());
+
+  ASSERT_TRUE(buffer.Push(3));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(buffer.Pop().value(), i);
+  }
+
+  ASSERT_TRUE(buffer.Push(4));
+  EXPECT_FALSE(buffer.Pop().has_value());
+  buffer.Flush();
+  EXPECT_EQ(buffer.Pop().value(), 4);
+}
+
+TEST_F(FastRingBufferTest, ConsumerBatchDefersRelease) {
+  FastRingBuffer<int, CapacityMode::PowerOfTwo> buffer(4, {}, {.consumerBatch = 2});
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(buffer.Push(i));
+  }
+  EXPECT_EQ(buffer.Pop().value(), 0);
+  // the slot is not handed back until the batch is full
+  EXPECT_FALSE(buffer.Push(4));
+
+  EXPECT_EQ(buffer.Pop().value(), 1);
+  EXPECT_TRUE(buffer.Push(4));
+  EXPECT_TRUE(buffer.Push(5));
+
+  EXPECT_EQ(buffer.Pop().value(), 2);
+  buffer.FlushConsumed();
+  EXPECT_TRUE(buffer.Push(6));
+}
+
+TEST_F(FastRingBufferTest, FullAndEmptyPublishPendingIndices) {
+  FastRingBuffer<int> buffer(8, {}, {.producerBatch = 1000, .consumerBatch = 1000});
+
+  // batches larger than the capacity still make progress: a full producer flushes its writes
+  // and an empty consumer hands back its slots
+  for (int round = 0; round < 5; ++round) {
+    int pushed = 0;
+    while (buffer.Push(round * 100 + pushed)) {
+      ++pushed;
+    }
+    EXPECT_EQ(pushed, 7);
+    for (int i = 0; i < pushed; ++i) {
+      ASSERT_EQ(buffer.Pop().value(), round * 100 + i);
+    }
+    EXPECT_FALSE(buffer.Pop().has_value());
+  }
+}
+
+TEST_F(FastRingBufferTest, BatchedBulkAndZeroCopy) {
+  FastRingBuffer<int, CapacityMode::PowerOfTwo> buffer(16, {}, {.producerBatch = 8});
+
+  std::vector<int> items{0, 1, 2, 3, 4};
+  ASSERT_EQ(buffer.PushBulk(std::span<const int>(items)), 5u);
+  auto slots = buffer.Reserve(3);
+  ASSERT_EQ(slots.size(), 3u);
+  std::iota(slots.begin(), slots.end(), 5);
+  // the commit completes the batch
+  buffer.Commit(3);
+
+  auto view = buffer.Peek(8);
+  ASSERT_EQ(view.size(), 8u);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(view[i], i);
+  }
+  buffer.Release(8);
+}
+
+TEST_F(FastRingBufferTest, UnpublishedElementsDestroyed) {
+  auto tracked = std::make_shared<int>(0);
+  {
+    FastRingBuffer<std::shared_ptr<int>> buffer(8, {}, {.producerBatch = 16});
+    for (int i = 0; i < 5; ++i) {
+      ASSERT_TRUE(buffer.Push(tracked));
+    }
+    EXPECT_EQ(tracked.use_count(), 6);
+  }
+  EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST_F(FastRingBufferTest, BatchedSPSC) {
+  const size_t num_items = 200000;
+  FastRingBuffer<size_t, CapacityMode::PowerOfTwo> buffer(
+    64, {}, {.producerBatch = 16, .consumerBatch = 8});
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      while (!buffer.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+    buffer.Flush();
+  });
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+  std::thread consumer([&]() {
+    while (consumed.size() < num_items) {
+      if (auto val = buffer.Pop()) {
+        consumed.push_back(*val);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  for (size_t i = 0; i < num_items; ++i) {
+    ASSERT_EQ(consumed[i], i);
+  }
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(FastRingBufferTest, StatsCountFullEmptyAndRefreshes) {
+  FastRingBuffer<int, CapacityMode::PowerOfTwo, CountingStats> buffer(4);
+
+  EXPECT_FALSE(buffer.Pop().has_value());
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(buffer.Push(i));
+  }
+  EXPECT_FALSE(buffer.Push(4));
+  int sink = 0;
+  EXPECT_EQ(buffer.PopBulk(&sink, 0), 0u);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(buffer.Pop().value(), i);
+  }
+  EXPECT_FALSE(buffer.Pop().has_value());
+
+  auto stats = buffer.Stats();
+  EXPECT_EQ(stats.pushFull, 1u);
+  // an empty request is not a failure
+  EXPECT_EQ(stats.popEmpty, 2u);
+  // one reload found the buffer full, the cached read index stays valid otherwise
+  EXPECT_EQ(stats.readIdxRefreshes, 1u);
+  // reloads found 0, 4 and 0 elements
+  EXPECT_EQ(stats.writeIdxRefreshes, 3u);
+  EXPECT_EQ(stats.highWater, 4u);
+}
+
+TEST_F(FastRingBufferTest, StatsCountBulkAndZeroCopy) {
+  FastRingBuffer<int, CapacityMode::PowerOfTwo, CountingStats> buffer(8);
+
+  std::vector<int> items(10);
+  std::iota(items.begin(), items.end(), 0);
+  EXPECT_EQ(buffer.PushBulk(std::span<const int>(items)), 8u);
+  EXPECT_EQ(buffer.PushBulk(std::span<const int>(items)), 0u);
+  EXPECT_TRUE(buffer.Reserve(1).empty());
+
+  std::vector<int> out;
+  EXPECT_EQ(buffer.PopBulk(std::back_inserter(out), 5), 5u);
+  EXPECT_EQ(buffer.Peek(8).size(), 3u);
+  buffer.Release(3);
+  EXPECT_TRUE(buffer.Peek(1).empty());
+
+  auto stats = buffer.Stats();
+  EXPECT_EQ(stats.pushFull, 2u);
+  EXPECT_EQ(stats.popEmpty, 1u);
+  EXPECT_EQ(stats.highWater, 8u);
+}
+
+TEST_F(FastRingBufferTest, EmptyReserveAndPeekAreNotFailures) {
+  FastRingBuffer<int, CapacityMode::PowerOfTwo, CountingStats> buffer(
+    4, {}, {.producerBatch = 4, .consumerBatch = 4});
+
+  ASSERT_TRUE(buffer.Push(0));
+  // neither counts as full nor publishes the pending write
+  EXPECT_TRUE(buffer.Reserve(0).empty());
+  EXPECT_FALSE(buffer.Pop().has_value());
+
+  buffer.Flush();
+  ASSERT_EQ(buffer.Pop().value(), 0);
+  // neither counts as empty nor hands the consumed slot back
+  EXPECT_TRUE(buffer.Peek(0).empty());
+  for (int i = 1; i < 4; ++i) {
+    ASSERT_TRUE(buffer.Push(i));
+  }
+  EXPECT_FALSE(buffer.Push(4));
+
+  auto stats = buffer.Stats();
+  EXPECT_EQ(stats.pushFull, 1u);
+  EXPECT_EQ(stats.popEmpty, 1u);
+}
+
+TEST_F(FastRingBufferTest, NoStatsCountsNothing) {
+  FastRingBuffer<int, CapacityMode::PowerOfTwo, NoStats> buffer(2);
+
+  EXPECT_FALSE(buffer.Pop().has_value());
+  ASSERT_TRUE(buffer.Push(1));
+  ASSERT_TRUE(buffer.Push(2));
+  EXPECT_FALSE(buffer.Push(3));
+
+  auto stats = buffer.Stats();
+  EXPECT_EQ(stats.pushFull, 0u);
+  EXPECT_EQ(stats.popEmpty, 0u);
+  EXPECT_EQ(stats.readIdxRefreshes, 0u);
+  EXPECT_EQ(stats.writeIdxRefreshes, 0u);
+  EXPECT_EQ(stats.highWater, 0u);
+  // the counters only take space when they count
+  EXPECT_LT(sizeof(buffer), sizeof(FastRingBuffer<int, CapacityMode::PowerOfTwo, CountingStats>));
+}
+
+TEST_F(FastRingBufferTest, StatsSnapshotWhileRunning) {
+  const size_t num_items = 100000;
+  FastRingBuffer<size_t, CapacityMode::PowerOfTwo, CountingStats> buffer(16);
+  std::atomic<bool> done{false};
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      while (!buffer.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::thread consumer([&]() {
+    for (size_t i = 0; i < num_items;) {
+      if (auto val = buffer.Pop()) {
+        EXPECT_EQ(*val, i);
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  // snapshots from a third thread only ever see counters grow
+  std::thread reader([&]() {
+    uint64_t lastRefreshes = 0;
+    while (!done.load()) {
+      auto stats = buffer.Stats();
+      EXPECT_GE(stats.writeIdxRefreshes, lastRefreshes);
+      EXPECT_LE(stats.highWater, buffer.Capacity());
+      lastRefreshes = stats.writeIdxRefreshes;
+      std::this_thread::yield();
+    }
+  });
+
+  producer.join();
+  consumer.join();
+  done.store(true);
+  reader.join();
+
+  auto stats = buffer.Stats();
+  EXPECT_GT(stats.writeIdxRefreshes, 0u);
+  EXPECT_LE(stats.highWater, buffer.Capacity());
+}
+
+TEST_F(FastRingBufferTest, ConsumeAllInPlace) {
+  auto tracked = std::make_shared<int>(0);
+  FastRingBuffer<std::shared_ptr<int>, CapacityMode::PowerOfTwo> buffer(8);
+
+  EXPECT_EQ(buffer.ConsumeAll([](std::shared_ptr<int>&) { FAIL(); }), 0u);
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 6; ++i) {
+      ASSERT_TRUE(buffer.Push(tracked));
+    }
+    size_t seen = 0;
+    // elements are handed out in place and destroyed afterwards
+    auto const count = buffer.ConsumeAll([&](std::shared_ptr<int>& val) {
+      EXPECT_EQ(val, tracked);
+      ++seen;
+    });
+    EXPECT_EQ(count, 6u);
+    EXPECT_EQ(seen, 6u);
+    EXPECT_EQ(tracked.use_count(), 1);
+  }
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(FastRingBufferTest, ConsumeUpToAcrossWrapPoint) {
+  FastRingBuffer<int> buffer(5);
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(buffer.Push(i));
+  }
+  ASSERT_EQ(buffer.Pop().value(), 0);
+  ASSERT_EQ(buffer.Pop().value(), 1);
+  for (int i = 3; i < 6; ++i) {
+    ASSERT_TRUE(buffer.Push(i));
+  }
+
+  std::vector<int> consumed;
+  auto collect = [&](int val) { consumed.push_back(val); };
+  EXPECT_EQ(buffer.ConsumeUpTo(0, collect), 0u);
+  EXPECT_EQ(buffer.ConsumeUpTo(3, collect), 3u);
+  EXPECT_EQ(buffer.ConsumeUpTo(3, collect), 1u);
+  EXPECT_EQ(consumed, (std::vector<int>{2, 3, 4, 5}));
+}
+
+TEST_F(FastRingBufferTest, ConsumeAllHandsSlotsBackWithConsumerBatch) {
+  FastRingBuffer<int, CapacityMode::PowerOfTwo, CountingStats> buffer(
+    4, {}, {.consumerBatch = 100});
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(buffer.Push(i));
+  }
+  EXPECT_EQ(buffer.ConsumeUpTo(2, [](int) {}), 2u);
+  // still in the consumer batch
+  EXPECT_FALSE(buffer.Push(4));
+  EXPECT_EQ(buffer.ConsumeAll([](int) {}), 2u);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(buffer.Push(i));
+  }
+
+  // one reload each: the cached copy was empty for ConsumeUpTo, ConsumeAll always reloads
+  EXPECT_EQ(buffer.Stats().writeIdxRefreshes, 2u);
+}
+
+TEST_F(FastRingBufferTest, ConsumeSPSC) {
+  const size_t num_items = 200000;
+  FastRingBuffer<size_t, CapacityMode::PowerOfTwo> buffer(64);
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      while (!buffer.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+  std::thread consumer([&]() {
+    while (consumed.size() < num_items) {
+      auto collect = [&](size_t val) { consumed.push_back(val); };
+      auto const count = consumed.size() % 2 == 0 ? buffer.ConsumeAll(collect)
+                                                  : buffer.ConsumeUpTo(7, collect);
+      if (count == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  for (size_t i = 0; i < num_items; ++i) {
+    ASSERT_EQ(consumed[i], i);
+  }
+}
+
+TEST_F(FastRingBufferTest, PrefetchAcrossWrapPoint) {
+  struct Large {
+    size_t seq;
+    char pad[248];
+  };
+  // distances at and past the capacity are clamped
+  for (size_t distance : {1, 3, 5, 100}) {
+    FastRingBuffer<Large> buffer(
+      6, {}, {}, PrefetchOptions{.consumerDistance = distance, .producerDistance = distance});
+    size_t pushed = 0;
+    size_t popped = 0;
+    for (size_t round = 0; round < 20; ++round) {
+      while (buffer.Push(Large{.seq = pushed, .pad = {}})) {
+        ++pushed;
+      }
+      while (auto val = buffer.Pop()) {
+        ASSERT_EQ(val->seq, popped++);
+      }
+    }
+    EXPECT_EQ(popped, pushed);
+  }
+}
+
+TEST_F(FastRingBufferTest, PrefetchSPSC) {
+  const size_t num_items = 100000;
+  FastRingBuffer<std::string, CapacityMode::PowerOfTwo> buffer(
+    32, {}, {}, PrefetchOptions{.consumerDistance = 4, .producerDistance = 8});
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      while (!buffer.Push(std::to_string(i))) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::thread consumer([&]() {
+    for (size_t i = 0; i < num_items;) {
+      if (auto val = buffer.Pop()) {
+        ASSERT_EQ(*val, std::to_string(i));
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+}
+
+TEST_F(FastRingBufferTest, TriviallyCopyableBulkAcrossWrapPoint) {
+  struct Tick {
+    uint32_t id;
+    float price;
+    uint64_t time;
+    char side;
+  };
+  static_assert(std::is_trivially_copyable_v<Tick>);
+
+  for (auto mode : {CopyMode::Cached, CopyMode::NonTemporal}) {
+    FastRingBuffer<Tick> buffer(101);
+    // odd batch sizes and an odd destination offset, so no run or copy is aligned
+    std::vector<Tick> items(37);
+    std::vector<Tick> out(38);
+    uint32_t pushed = 0;
+    uint32_t popped = 0;
+    for (int round = 0; round < 20; ++round) {
+      for (auto& item : items) {
+        item = Tick{pushed, pushed * 0.5f, pushed * 3ull, static_cast<char>('a' + pushed % 26)};
+        ++pushed;
+      }
+      ASSERT_EQ(buffer.PushBulk(std::span<const Tick>(items), mode), items.size());
+
+      ASSERT_EQ(buffer.PopBulk(out.data() + 1, items.size(), mode), items.size());
+      for (size_t i = 0; i < items.size(); ++i, ++popped) {
+        const auto& tick = out[i + 1];
+        ASSERT_EQ(tick.id, popped);
+        ASSERT_EQ(tick.price, popped * 0.5f);
+        ASSERT_EQ(tick.time, popped * 3ull);
+        ASSERT_EQ(tick.side, static_cast<char>('a' + popped % 26));
+      }
+    }
+  }
+}
+
+TEST_F(FastRingBufferTest, TriviallyCopyableBulkToNonContiguousOutput) {
+  FastRingBuffer<uint64_t, CapacityMode::PowerOfTwo> buffer(16);
+
+  std::vector<uint64_t> items(12);
+  std::iota(items.begin(), items.end(), 0);
+  std::vector<uint64_t> out;
+  for (int round = 0; round < 3; ++round) {
+    ASSERT_EQ(buffer.PushBulk(std::span(items), CopyMode::NonTemporal), 12u);
+    ASSERT_EQ(buffer.PopBulk(std::back_inserter(out), 12, CopyMode::NonTemporal), 12u);
+  }
+  ASSERT_EQ(out.size(), 36u);
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_EQ(out[i], i % 12);
+  }
+}
+
+TEST_F(FastRingBufferTest, NonTemporalBulkSPSC) {
+  const size_t num_items = 200000;
+  const size_t batch = 64;
+  FastRingBuffer<uint64_t, CapacityMode::PowerOfTwo> buffer(1024);
+
+  std::thread producer([&]() {
+    std::vector<uint64_t> items(batch);
+    for (size_t next = 0; next < num_items;) {
+      const size_t count = std::min(batch, num_items - next);
+      std::iota(items.begin(), items.begin() + count, next);
+      for (size_t pushed = 0; pushed < count;) {
+        const size_t n = buffer.PushBulk(
+          std::span<const uint64_t>(items.data() + pushed, count - pushed), CopyMode::NonTemporal);
+        if (n == 0) {
+          std::this_thread::yield();
+        }
+        pushed += n;
+      }
+      next += count;
+    }
+  });
+
+  std::vector<uint64_t> consumed(num_items);
+  std::thread consumer([&]() {
+    for (size_t popped = 0; popped < num_items;) {
+      const size_t n =
+        buffer.PopBulk(consumed.data() + popped, std::min(batch, num_items - popped),
+                       CopyMode::NonTemporal);
+      if (n == 0) {
+        std::this_thread::yield();
+      }
+      popped += n;
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  for (size_t i = 0; i < num_items; ++i) {
+    ASSERT_EQ(consumed[i], i);
+  }
+}
+
+TEST_F(FastRingBufferTest, HugePageStorage) {
+  // which kind of page backs the slots depends on the system, every kind must work
+  FastRingBuffer<size_t, CapacityMode::PowerOfTwo> buffer(
+    1 << 16, StorageOptions{.hugePages = true, .prefault = true});
+
+  for (size_t round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < buffer.Capacity(); ++i) {
+      ASSERT_TRUE(buffer.Push(round + i));
+    }
+    EXPECT_FALSE(buffer.Push(0));
+    for (size_t i = 0; i < buffer.Capacity(); ++i) {
+      ASSERT_EQ(buffer.Pop().value(), round + i);
+    }
+  }
+}
+
+TEST_F(FastRingBufferTest, DefaultStorageIsRegularPages) {
+  FastRingBuffer<int> buffer(16, StorageOptions{.prefault = true});
+
+  EXPECT_EQ(buffer.Backing(), PageBacking::Regular);
+  EXPECT_TRUE(buffer.Push(1));
+  EXPECT_EQ(buffer.Pop().value(), 1);
+}
+
+TEST_F(FastRingBufferTest, PrefaultCoversUnalignedBlock) {
+  // a heap block of slots starts on a cache line, not on a page, and rarely ends on one
+  constexpr size_t kPages = 6;
+  void* region = ::mmap(nullptr, kPages * os::kPageSize, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(region, MAP_FAILED);
+  auto* data = static_cast<std::byte*>(region) + os::kL1CacheLineSize;
+  const size_t bytes = 4 * os::kPageSize - 32;
+
+  os::memory::Prefault(data, bytes);
+
+  // every page from the one holding the first byte to the one holding the last must be resident
+  unsigned char resident[kPages] = {};
+  ASSERT_EQ(::mincore(region, kPages * os::kPageSize, resident), 0);
+  const size_t lastPage = (os::kL1CacheLineSize + bytes - 1) / os::kPageSize;
+  for (size_t page = 0; page <= lastPage; ++page) {
+    EXPECT_TRUE(resident[page] & 1) << "page " << page;
+  }
+  ::munmap(region, kPages * os::kPageSize);
+
+  // and through the heap path of the slot storage
+  FastRingBuffer<std::array<char, 24>> buffer(1000, StorageOptions{.prefault = true});
+  EXPECT_TRUE(buffer.Push({}));
+  EXPECT_TRUE(buffer.Pop().has_value());
+}
+
+TEST_F(FastRingBufferTest, NumaPlacement) {
+  const int node = os::memory::CurrentNode();
+  auto buffer = MakeNodeLocal<FastRingBuffer<size_t, CapacityMode::PowerOfTwo>>(
+    node, 1 << 12, StorageOptions{.prefault = true, .numaNode = node});
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.get()) % os::kPageSize, 0u);
+  // binding needs a kernel with NUMA support, the ring works on unbound pages otherwise
+  if (buffer->NumaNode() != os::memory::kAnyNode) {
+    EXPECT_EQ(buffer->NumaNode(), node);
+  }
+
+  for (size_t i = 0; i < 2 * buffer->Capacity(); ++i) {
+    ASSERT_TRUE(buffer->Push(i));
+    ASSERT_EQ(buffer->Pop().value(), i);
+  }
+}
+
+TEST_F(FastRingBufferTest, NumaPlacementOnMissingNodeFallsBack) {
+  FastRingBuffer<int> buffer(16, StorageOptions{.numaNode = 1000});
+
+  EXPECT_EQ(buffer.NumaNode(), os::memory::kAnyNode);
+  EXPECT_TRUE(buffer.Push(1));
+  EXPECT_EQ(buffer.Pop().value(), 1);
+}
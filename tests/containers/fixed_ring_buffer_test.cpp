@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include <common/containers/fixed_ring_buffer.hpp>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <os/constants.hpp>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+using common::containers::CopyMode;
+using common::containers::CountingStats;
+using common::containers::FixedRingBuffer;
+
+namespace {
+
+struct Tick {
+  uint64_t seq;
+  double price;
+  uint32_t quantity;
+};
+
+// Per-thread state with its rings embedded, the way FixedRingBuffer is meant to be used
+struct Worker {
+  uint64_t id;
+  FixedRingBuffer<Tick, 64> inbox;
+  FixedRingBuffer<uint64_t, 16> acks;
+};
+
+}  // namespace
+
+class FixedRingBufferTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+  }
+
+  void TearDown() override {
+  }
+};
+
+TEST_F(FixedRingBufferTest, BasicPushPop) {
+  FixedRingBuffer<int, 8> buffer;
+
+  EXPECT_TRUE(buffer.Push(42));
+  auto val = buffer.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(val.value(), 42);
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(FixedRingBufferTest, FillBuffer) {
+  FixedRingBuffer<int, 16> buffer;
+  static_assert(FixedRingBuffer<int, 16>::Capacity() == 16);
+
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_TRUE(buffer.Push(i));
+  }
+  EXPECT_FALSE(buffer.Push(16));
+
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_EQ(buffer.Pop().value(), i);
+  }
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(FixedRingBufferTest, StorageIsInline) {
+  auto worker = std::make_unique<Worker>();
+
+  // slots and indices live in the object itself, no pointer to chase
+  static_assert(sizeof(FixedRingBuffer<Tick, 64>) >= 64 * sizeof(Tick));
+  static_assert(alignof(FixedRingBuffer<Tick, 64>) == os::kL1CacheLineSize);
+  auto const begin = reinterpret_cast<uintptr_t>(&worker->inbox);
+  EXPECT_EQ(begin % os::kL1CacheLineSize, 0u);
+
+  ASSERT_TRUE(worker->inbox.Emplace(Tick{1, 2.5, 10}));
+  ASSERT_TRUE(worker->acks.Push(1));
+  EXPECT_EQ(worker->inbox.Pop()->seq, 1u);
+  EXPECT_EQ(worker->acks.Pop().value(), 1u);
+}
+
+TEST_F(FixedRingBufferTest, WrapAround) {
+  FixedRingBuffer<int, 4> buffer;
+
+  for (int round = 0; round < 100; ++round) {
+    ASSERT_TRUE(buffer.Push(round));
+    ASSERT_TRUE(buffer.Push(round + 1));
+    ASSERT_TRUE(buffer.Push(round + 2));
+    ASSERT_EQ(buffer.Pop().value(), round);
+    ASSERT_EQ(buffer.Pop().value(), round + 1);
+    ASSERT_EQ(buffer.Pop().value(), round + 2);
+  }
+}
+
+TEST_F(FixedRingBufferTest, MoveOnly) {
+  FixedRingBuffer<std::unique_ptr<std::string>, 4> buffer;
+
+  EXPECT_TRUE(buffer.Push(std::make_unique<std::string>("hello")));
+  EXPECT_TRUE(buffer.TryEmplace([] { return std::make_unique<std::string>("world"); }));
+  EXPECT_EQ(*buffer.Pop().value(), "hello");
+  EXPECT_EQ(*buffer.Pop().value(), "world");
+}
+
+TEST_F(FixedRingBufferTest, ElementLifetime) {
+  auto tracked = std::make_shared<int>(0);
+  {
+    FixedRingBuffer<std::shared_ptr<int>, 8> buffer;
+    for (int round = 0; round < 3; ++round) {
+      for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(buffer.Push(tracked));
+      }
+      buffer.Pop();
+    }
+    EXPECT_EQ(tracked.use_count(), 1 + 6);
+  }
+  EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST_F(FixedRingBufferTest, BulkAcrossWrapPoint) {
+  FixedRingBuffer<Tick, 32> buffer;
+  std::vector<Tick> items(13);
+  uint64_t next = 0;
+  uint64_t expected = 0;
+
+  for (int round = 0; round < 20; ++round) {
+    for (auto& item : items) {
+      item = {next++, 1.0, 1};
+    }
+    const auto mode = round % 2 == 0 ? CopyMode::Cached : CopyMode::NonTemporal;
+    ASSERT_EQ(buffer.PushBulk(std::span<const Tick>(items), mode), items.size());
+
+    std::vector<Tick> out(items.size());
+    ASSERT_EQ(buffer.PopBulk(out.begin(), out.size(), mode), out.size());
+    for (const auto& tick : out) {
+      ASSERT_EQ(tick.seq, expected++);
+    }
+  }
+}
+
+TEST_F(FixedRingBufferTest, BulkMovesNonTrivialElements) {
+  FixedRingBuffer<std::string, 8> buffer;
+  std::vector<std::string> items{"a", "b", "c", "d", "e", "f"};
+
+  EXPECT_EQ(buffer.PushBulk(std::span(items)), 6u);
+  EXPECT_EQ(buffer.PushBulk(std::span(items)), 2u);
+
+  std::vector<std::string> out;
+  EXPECT_EQ(buffer.PopBulk(std::back_inserter(out), 5), 5u);
+  EXPECT_EQ(out, (std::vector<std::string>{"a", "b", "c", "d", "e"}));
+  EXPECT_EQ(buffer.Pop().value(), "f");
+}
+
+TEST_F(FixedRingBufferTest, ConsumeInPlace) {
+  FixedRingBuffer<int, 16> buffer;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(buffer.Push(i));
+  }
+
+  std::vector<int> seen;
+  EXPECT_EQ(buffer.ConsumeUpTo(4, [&](int& val) { seen.push_back(val); }), 4u);
+  EXPECT_EQ(buffer.ConsumeAll([&](int& val) { seen.push_back(val); }), 6u);
+  EXPECT_EQ(buffer.ConsumeAll([&](int& val) { seen.push_back(val); }), 0u);
+
+  std::vector<int> expected(10);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(seen, expected);
+}
+
+TEST_F(FixedRingBufferTest, SharesFastRingBufferOperations) {
+  FixedRingBuffer<std::string, 8, CountingStats> buffer({.producerBatch = 4});
+
+  auto slots = buffer.Reserve(2);
+  ASSERT_EQ(slots.size(), 2u);
+  std::construct_at(&slots[0], "a");
+  std::construct_at(&slots[1], "b");
+  buffer.Commit(2);
+  // still in the producer's batch
+  EXPECT_TRUE(buffer.Peek(2).empty());
+
+  buffer.Flush();
+  auto elements = buffer.Peek(2);
+  ASSERT_EQ(elements.size(), 2u);
+  EXPECT_EQ(elements[0], "a");
+  EXPECT_EQ(elements[1], "b");
+  buffer.Release(2);
+
+  buffer.WaitPush("c");
+  EXPECT_EQ(buffer.WaitPop(), "c");
+  EXPECT_EQ(buffer.Stats().popEmpty, 1u);
+}
+
+TEST_F(FixedRingBufferTest, HighContentionSPSC) {
+  const size_t num_items = 200000;
+  auto buffer = std::make_unique<FixedRingBuffer<size_t, 64>>();
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      while (!buffer->Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+  std::thread consumer([&]() {
+    while (consumed.size() < num_items) {
+      if (auto val = buffer->Pop()) {
+        consumed.push_back(*val);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  for (size_t i = 0; i < num_items; ++i) {
+    ASSERT_EQ(consumed[i], i);
+  }
+  EXPECT_FALSE(buffer->Pop().has_value());
+}
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <common/containers/journal_ring_buffer.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using common::containers::JournalRingBuffer;
+
+namespace {
+
+struct Order {
+  uint64_t id;
+  double price;
+  uint32_t quantity;
+};
+
+// Makes the journal look as if it was last written before a reboot
+void ForgetBootId(const std::string& path) {
+  using common::containers::detail::JournalHeader;
+  int fd = ::open(path.c_str(), O_RDWR);
+  ASSERT_GE(fd, 0);
+  void* mapping = ::mmap(nullptr, sizeof(JournalHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ASSERT_NE(mapping, MAP_FAILED);
+  static_cast<JournalHeader*>(mapping)->bootId.fill('x');
+  ::munmap(mapping, sizeof(JournalHeader));
+  ::close(fd);
+}
+
+}  // namespace
+
+class JournalRingBufferTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "journal_" + std::to_string(::getpid()) + "_" +
+            ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::remove(path_);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(path_);
+  }
+
+  std::string path_;
+};
+
+TEST_F(JournalRingBufferTest, BasicPushPop) {
+  auto journal = JournalRingBuffer<int>::Create(path_.c_str(), 8);
+
+  EXPECT_TRUE(journal.Push(42));
+  auto val = journal.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(val.value(), 42);
+  EXPECT_FALSE(journal.Pop().has_value());
+  EXPECT_FALSE(journal.Rebooted());
+}
+
+TEST_F(JournalRingBufferTest, SlotsAreReusedOnlyAfterSync) {
+  auto journal = JournalRingBuffer<int>::Create(path_.c_str(), 6);
+  ASSERT_EQ(journal.Capacity(), 8u);
+
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_TRUE(journal.Push(i));
+  }
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_EQ(journal.Pop().value(), i);
+  }
+  EXPECT_FALSE(journal.Push(8));
+
+  journal.Sync();
+  for (int i = 8; i < 16; ++i) {
+    EXPECT_TRUE(journal.Push(i));
+  }
+  EXPECT_FALSE(journal.Push(16));
+}
+
+TEST_F(JournalRingBufferTest, BulkAcrossWrapPoint) {
+  auto journal = JournalRingBuffer<uint64_t>::Create(path_.c_str(), 16);
+  std::vector<uint64_t> items(11);
+  uint64_t next = 0;
+  uint64_t expected = 0;
+
+  for (int round = 0; round < 20; ++round) {
+    for (auto& item : items) {
+      item = next++;
+    }
+    ASSERT_EQ(journal.PushBulk(std::span<const uint64_t>(items)), items.size());
+
+    std::vector<uint64_t> out(items.size());
+    ASSERT_EQ(journal.PopBulk(out.begin(), out.size()), out.size());
+    for (auto val : out) {
+      ASSERT_EQ(val, expected++);
+    }
+    journal.Sync();
+  }
+  EXPECT_EQ(journal.WriteSequence(), 220u);
+}
+
+TEST_F(JournalRingBufferTest, ReopenAfterCrashKeepsUnsyncedProgress) {
+  {
+    auto journal = JournalRingBuffer<Order>::Create(path_.c_str(), 16);
+    for (uint64_t i = 0; i < 10; ++i) {
+      ASSERT_TRUE(journal.Push({i, 1.5, 100}));
+    }
+    journal.Sync();
+    for (uint64_t i = 10; i < 15; ++i) {
+      ASSERT_TRUE(journal.Push({i, 1.5, 100}));
+    }
+    ASSERT_EQ(journal.Pop()->id, 0u);
+    ASSERT_EQ(journal.Pop()->id, 1u);
+  }
+
+  // same boot, the page cache still holds the live indices
+  auto journal = JournalRingBuffer<Order>::Open(path_.c_str());
+  EXPECT_FALSE(journal.Rebooted());
+  EXPECT_EQ(journal.ReadSequence(), 2u);
+  EXPECT_EQ(journal.WriteSequence(), 15u);
+  for (uint64_t i = 2; i < 15; ++i) {
+    ASSERT_EQ(journal.Pop()->id, i);
+  }
+  EXPECT_FALSE(journal.Pop().has_value());
+}
+
+TEST_F(JournalRingBufferTest, ReopenAfterRebootFallsBackToSyncedIndices) {
+  {
+    auto journal = JournalRingBuffer<Order>::Create(path_.c_str(), 16);
+    for (uint64_t i = 0; i < 10; ++i) {
+      ASSERT_TRUE(journal.Push({i, 1.5, 100}));
+    }
+    ASSERT_EQ(journal.Pop()->id, 0u);
+    journal.Sync();
+    for (uint64_t i = 10; i < 15; ++i) {
+      ASSERT_TRUE(journal.Push({i, 1.5, 100}));
+    }
+    ASSERT_EQ(journal.Pop()->id, 1u);
+  }
+  ForgetBootId(path_);
+
+  // pushes after the Sync are lost, pops after it are replayed
+  auto journal = JournalRingBuffer<Order>::Open(path_.c_str());
+  EXPECT_TRUE(journal.Rebooted());
+  EXPECT_EQ(journal.ReadSequence(), 1u);
+  EXPECT_EQ(journal.WriteSequence(), 10u);
+  for (uint64_t i = 1; i < 10; ++i) {
+    ASSERT_EQ(journal.Pop()->id, i);
+  }
+  EXPECT_FALSE(journal.Pop().has_value());
+
+  // and the journal keeps going from there
+  EXPECT_TRUE(journal.Push({10, 2.5, 1}));
+  EXPECT_EQ(journal.Pop()->id, 10u);
+}
+
+TEST_F(JournalRingBufferTest, OpenRejectsOtherFiles) {
+  {
+    auto journal = JournalRingBuffer<uint64_t>::Create(path_.c_str(), 16);
+  }
+  EXPECT_THROW(JournalRingBuffer<Order>::Open(path_.c_str()), std::runtime_error);
+  EXPECT_THROW(JournalRingBuffer<uint64_t>::Create(path_.c_str(), 16), std::system_error);
+
+  std::filesystem::remove(path_);
+  EXPECT_THROW(JournalRingBuffer<uint64_t>::Open(path_.c_str()), std::system_error);
+
+  std::vector<char> garbage(4096, 'x');
+  int fd = ::open(path_.c_str(), O_RDWR | O_CREAT, 0644);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(::write(fd, garbage.data(), garbage.size()), static_cast<ssize_t>(garbage.size()));
+  ::close(fd);
+  EXPECT_THROW(JournalRingBuffer<uint64_t>::Open(path_.c_str()), std::runtime_error);
+}
+
+TEST_F(JournalRingBufferTest, FailedCreateLeavesNoFile) {
+  // far beyond any file system's maximum file size, so posix_fallocate fails
+  EXPECT_THROW(JournalRingBuffer<uint64_t>::Create(path_.c_str(), size_t{1} << 56),
+               std::system_error);
+  EXPECT_FALSE(std::filesystem::exists(path_));
+
+  auto journal = JournalRingBuffer<uint64_t>::Create(path_.c_str(), 16);
+  EXPECT_TRUE(journal.Push(1));
+}
+
+TEST_F(JournalRingBufferTest, OnlyOneOwner) {
+  auto journal = JournalRingBuffer<uint64_t>::Create(path_.c_str(), 16);
+
+  EXPECT_THROW(JournalRingBuffer<uint64_t>::Open(path_.c_str()), std::system_error);
+}
+
+TEST_F(JournalRingBufferTest, SPSCWithSyncThread) {
+  const size_t num_items = 100000;
+  auto journal = JournalRingBuffer<size_t>::Create(path_.c_str(), 256);
+  std::atomic<bool> done{false};
+
+  std::thread syncer([&]() {
+    while (!done.load()) {
+      journal.Sync();
+      std::this_thread::yield();
+    }
+  });
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      while (!journal.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+  std::thread consumer([&]() {
+    while (consumed.size() < num_items) {
+      if (auto val = journal.Pop()) {
+        consumed.push_back(*val);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+  done.store(true);
+  syncer.join();
+
+  for (size_t i = 0; i < num_items; ++i) {
+    ASSERT_EQ(consumed[i], i);
+  }
+  EXPECT_EQ(journal.ReadSequence(), num_items);
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <common/containers/mpmc_queue.hpp>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using common::containers::MPMCQueue;
+
+namespace {
+
+// Throws from its constructor when asked to, to check that a failed Emplace does not wedge a slot
+struct MaybeThrowing {
+  MaybeThrowing(int val, bool fail) : value(val) {
+    if (fail) {
+      throw std::runtime_error("constructor failed");
+    }
+  }
+
+  int value;
+};
+
+}  // namespace
+
+class MPMCQueueTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+  }
+
+  void TearDown() override {
+  }
+};
+
+TEST_F(MPMCQueueTest, BasicPushPop) {
+  MPMCQueue<int> queue(8);
+
+  EXPECT_TRUE(queue.Push(42));
+  auto val = queue.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(val.value(), 42);
+}
+
+TEST_F(MPMCQueueTest, EmptyPop) {
+  MPMCQueue<int> queue(8);
+
+  EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST_F(MPMCQueueTest, FillQueue) {
+  MPMCQueue<int> queue(5);
+  ASSERT_EQ(queue.Capacity(), 8u);
+
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_TRUE(queue.Push(i));
+  }
+  EXPECT_FALSE(queue.Push(999));
+
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(queue.Pop().value(), i);
+  }
+  EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST_F(MPMCQueueTest, SingleElementCapacity) {
+  MPMCQueue<int> queue(1);
+  ASSERT_EQ(queue.Capacity(), 2u);
+
+  EXPECT_TRUE(queue.Push(1));
+  EXPECT_TRUE(queue.Push(2));
+  EXPECT_FALSE(queue.Push(3));
+  EXPECT_EQ(queue.Pop().value(), 1);
+  EXPECT_EQ(queue.Pop().value(), 2);
+  EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST_F(MPMCQueueTest, WrapAround) {
+  MPMCQueue<int> queue(4);
+
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_TRUE(queue.Push(round * 10 + i));
+    }
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(queue.Pop().value(), round * 10 + i);
+    }
+  }
+}
+
+TEST_F(MPMCQueueTest, EmplaceMoveOnly) {
+  MPMCQueue<std::unique_ptr<std::string>> queue(4);
+
+  EXPECT_TRUE(queue.Emplace(std::make_unique<std::string>("hello")));
+  auto val = queue.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(**val, "hello");
+}
+
+TEST_F(MPMCQueueTest, DestroysRemainingElements) {
+  auto shared = std::make_shared<int>(0);
+  {
+    MPMCQueue<std::shared_ptr<int>> queue(8);
+    for (int i = 0; i < 5; ++i) {
+      queue.Push(shared);
+    }
+    queue.Pop();
+    EXPECT_EQ(shared.use_count(), 5);
+  }
+  EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST_F(MPMCQueueTest, ThrowingConstructorIsSkipped) {
+  MPMCQueue<MaybeThrowing> queue(4);
+
+  EXPECT_TRUE(queue.Emplace(1, false));
+  EXPECT_THROW(queue.Emplace(2, true), std::runtime_error);
+  EXPECT_TRUE(queue.Emplace(3, false));
+
+  EXPECT_EQ(queue.Pop()->value, 1);
+  EXPECT_EQ(queue.Pop()->value, 3);
+  EXPECT_FALSE(queue.Pop().has_value());
+
+  // the skipped slot is free again on the next lap
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.Emplace(i, false));
+  }
+  EXPECT_FALSE(queue.Emplace(4, false));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(queue.Pop()->value, i);
+  }
+}
+
+TEST_F(MPMCQueueTest, MultipleProducersMultipleConsumers) {
+  const size_t num_producers = 4;
+  const size_t num_consumers = 4;
+  const size_t items_per_producer = 20000;
+  const size_t total = num_producers * items_per_producer;
+  MPMCQueue<size_t> queue(64);
+
+  std::atomic<size_t> consumed{0};
+  std::vector<std::atomic<int>> seen(total);
+
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < num_producers; ++p) {
+    threads.emplace_back([&, p]() {
+      for (size_t i = 0; i < items_per_producer; ++i) {
+        while (!queue.Push(p * items_per_producer + i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (size_t c = 0; c < num_consumers; ++c) {
+    threads.emplace_back([&]() {
+      while (consumed.load() < total) {
+        if (auto val = queue.Pop()) {
+          seen[*val].fetch_add(1);
+          consumed.fetch_add(1);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // every element is delivered exactly once
+  for (size_t i = 0; i < total; ++i) {
+    ASSERT_EQ(seen[i].load(), 1) << "element " << i;
+  }
+}
@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <common/containers/mpsc_ring_buffer.hpp>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using common::containers::MPSCRingBuffer;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Throws from its constructor when asked to, to check that a failed Emplace does not wedge a slot
+struct MaybeThrowing {
+  MaybeThrowing(int val, bool fail) : value(val) {
+    if (fail) {
+      throw std::runtime_error("constructor failed");
+    }
+  }
+
+  int value;
+};
+
+}  // namespace
+
+class MPSCRingBufferTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+  }
+
+  void TearDown() override {
+  }
+};
+
+TEST_F(MPSCRingBufferTest, BasicPushPop) {
+  MPSCRingBuffer<int> buffer(8);
+
+  EXPECT_TRUE(buffer.Push(42));
+  auto val = buffer.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(val.value(), 42);
+}
+
+TEST_F(MPSCRingBufferTest, EmptyPop) {
+  MPSCRingBuffer<int> buffer(8);
+
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(MPSCRingBufferTest, FillBuffer) {
+  MPSCRingBuffer<int> buffer(10);
+  ASSERT_EQ(buffer.Capacity(), 16u);
+
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_TRUE(buffer.Push(i));
+  }
+  EXPECT_FALSE(buffer.Push(999));
+
+  EXPECT_EQ(buffer.Pop().value(), 0);
+  EXPECT_TRUE(buffer.Push(16));
+}
+
+TEST_F(MPSCRingBufferTest, SingleElementCapacity) {
+  MPSCRingBuffer<int> buffer(1);
+  ASSERT_EQ(buffer.Capacity(), 2u);
+
+  EXPECT_TRUE(buffer.Push(1));
+  EXPECT_TRUE(buffer.Push(2));
+  EXPECT_FALSE(buffer.Push(3));
+  EXPECT_EQ(buffer.Pop().value(), 1);
+  EXPECT_EQ(buffer.Pop().value(), 2);
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(MPSCRingBufferTest, WrapAround) {
+  MPSCRingBuffer<int> buffer(4);
+
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_TRUE(buffer.Push(round * 10 + i));
+    }
+    for (int i = 0; i < 4; ++i) {
+      auto val = buffer.Pop();
+      ASSERT_TRUE(val.has_value());
+      EXPECT_EQ(val.value(), round * 10 + i);
+    }
+  }
+}
+
+TEST_F(MPSCRingBufferTest, EmplaceMoveOnly) {
+  MPSCRingBuffer<std::unique_ptr<std::string>> buffer(4);
+
+  EXPECT_TRUE(buffer.Emplace(std::make_unique<std::string>("hello")));
+  auto val = buffer.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(**val, "hello");
+}
+
+TEST_F(MPSCRingBufferTest, DestroysRemainingElements) {
+  auto shared = std::make_shared<int>(0);
+  {
+    MPSCRingBuffer<std::shared_ptr<int>> buffer(8);
+    for (int i = 0; i < 5; ++i) {
+      buffer.Push(shared);
+    }
+    buffer.Pop();
+    EXPECT_EQ(shared.use_count(), 5);
+  }
+  EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST_F(MPSCRingBufferTest, ThrowingConstructorIsSkipped) {
+  MPSCRingBuffer<MaybeThrowing> buffer(4);
+
+  EXPECT_TRUE(buffer.Emplace(1, false));
+  EXPECT_THROW(buffer.Emplace(2, true), std::runtime_error);
+  EXPECT_TRUE(buffer.Emplace(3, false));
+
+  EXPECT_EQ(buffer.Pop()->value, 1);
+  EXPECT_EQ(buffer.Pop()->value, 3);
+  EXPECT_FALSE(buffer.Pop().has_value());
+
+  // the skipped slot is free again on the next lap
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(buffer.Emplace(i, false));
+  }
+  EXPECT_FALSE(buffer.Emplace(4, false));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(buffer.Pop()->value, i);
+  }
+}
+
+TEST_F(MPSCRingBufferTest, FillWhileConsumerPaused) {
+  const size_t num_producers = 4;
+  const size_t capacity = 8;
+  MPSCRingBuffer<std::pair<size_t, size_t>> buffer(capacity);
+  std::atomic<size_t> pushed{0};
+
+  // each producer pushes until it sees the buffer full. One that passed the admission check just
+  // before the buffer filled up has claimed a ticket of the next lap and waits for the consumer.
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < num_producers; ++p) {
+    producers.emplace_back([&, p]() {
+      for (size_t i = 0; i < capacity; ++i) {
+        if (!buffer.Emplace(p, i)) {
+          return;
+        }
+        pushed.fetch_add(1);
+      }
+    });
+  }
+
+  while (pushed.load() < capacity) {
+    std::this_thread::yield();
+  }
+  // nothing gets past a full buffer while the consumer is paused
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(pushed.load(), capacity);
+
+  std::vector<size_t> next(num_producers, 0);
+  size_t consumed = 0;
+  auto drain = [&] {
+    while (auto val = buffer.Pop()) {
+      auto [producer, seq] = *val;
+      ASSERT_EQ(seq, next[producer]);
+      ++next[producer];
+      ++consumed;
+    }
+  };
+  drain();
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  drain();
+
+  // every Emplace that returned true, including the ones that had to wait, was delivered
+  EXPECT_EQ(consumed, pushed.load());
+  EXPECT_GE(consumed, capacity);
+}
+
+TEST_F(MPSCRingBufferTest, MultipleProducers) {
+  const size_t num_producers = 8;
+  const size_t items_per_producer = 20000;
+  MPSCRingBuffer<std::pair<size_t, size_t>> buffer(64);
+
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < num_producers; ++p) {
+    producers.emplace_back([&, p]() {
+      for (size_t i = 0; i < items_per_producer; ++i) {
+        while (!buffer.Emplace(p, i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // elements of a single producer must arrive in the order they were pushed
+  std::vector<size_t> next(num_producers, 0);
+  size_t consumed = 0;
+  while (consumed < num_producers * items_per_producer) {
+    auto val = buffer.Pop();
+    if (!val.has_value()) {
+      std::this_thread::yield();
+      continue;
+    }
+    auto [producer, seq] = *val;
+    ASSERT_EQ(seq, next[producer]);
+    ++next[producer];
+    ++consumed;
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_FALSE(buffer.Pop().has_value());
+  for (size_t p = 0; p < num_producers; ++p) {
+    EXPECT_EQ(next[p], items_per_producer);
+  }
+}
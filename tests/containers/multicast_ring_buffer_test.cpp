@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <common/containers/multicast_ring_buffer.hpp>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using common::containers::MulticastRingBuffer;
+
+namespace {
+
+// Keeps count of the instances alive in `live`
+struct Counted {
+  Counted(int& live, bool fail) : live(live) {
+    if (fail) {
+      throw std::runtime_error("constructor failed");
+    }
+    ++live;
+  }
+
+  Counted(const Counted&) = delete;
+  Counted& operator=(const Counted&) = delete;
+
+  ~Counted() {
+    --live;
+  }
+
+  int& live;
+};
+
+}  // namespace
+
+class MulticastRingBufferTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+  }
+
+  void TearDown() override {
+  }
+};
+
+TEST_F(MulticastRingBufferTest, EveryConsumerSeesEveryElement) {
+  MulticastRingBuffer<std::string> buffer(8);
+  auto& risk = buffer.AddConsumer();
+  auto& persistence = buffer.AddConsumer();
+
+  EXPECT_TRUE(buffer.Push("first"));
+  EXPECT_TRUE(buffer.Emplace("second"));
+
+  for (auto* consumer : {&risk, &persistence}) {
+    auto items = consumer->Peek(10);
+    ASSERT_EQ(items.size(), 2u);
+    EXPECT_EQ(items[0], "first");
+    EXPECT_EQ(items[1], "second");
+    consumer->Release(items.size());
+    EXPECT_TRUE(consumer->Peek().empty());
+  }
+}
+
+TEST_F(MulticastRingBufferTest, ProducerGatesOnSlowestConsumer) {
+  MulticastRingBuffer<int> buffer(4);
+  auto& fast = buffer.AddConsumer();
+  auto& slow = buffer.AddConsumer();
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(buffer.Push(i));
+  }
+  EXPECT_FALSE(buffer.Push(4));
+
+  fast.Release(fast.Peek(4).size());
+  EXPECT_FALSE(buffer.Push(4));
+
+  EXPECT_EQ(slow.Peek().front(), 0);
+  slow.Release(1);
+  EXPECT_TRUE(buffer.Push(4));
+  EXPECT_FALSE(buffer.Push(5));
+}
+
+TEST_F(MulticastRingBufferTest, DependentConsumerWaitsForItsDependencies) {
+  MulticastRingBuffer<int> buffer(8);
+  auto& journal = buffer.AddConsumer();
+  auto& replicate = buffer.AddConsumer();
+  auto& business = buffer.AddConsumer({&journal, &replicate});
+
+  buffer.Push(1);
+  buffer.Push(2);
+  EXPECT_TRUE(business.Peek().empty());
+
+  journal.Release(journal.Peek(2).size());
+  EXPECT_TRUE(business.Peek().empty());
+
+  replicate.Release(1);
+  auto items = business.Peek(2);
+  ASSERT_EQ(items.size(), 1u);
+  EXPECT_EQ(items[0], 1);
+}
+
+TEST_F(MulticastRingBufferTest, PeekStopsAtWrapPoint) {
+  MulticastRingBuffer<int> buffer(4);
+  auto& consumer = buffer.AddConsumer();
+
+  for (int i = 0; i < 3; ++i) {
+    buffer.Push(i);
+  }
+  consumer.Release(consumer.Peek(3).size());
+  for (int i = 3; i < 6; ++i) {
+    buffer.Push(i);
+  }
+
+  auto items = consumer.Peek(3);
+  ASSERT_EQ(items.size(), 1u);
+  EXPECT_EQ(items[0], 3);
+  consumer.Release(1);
+
+  items = consumer.Peek(3);
+  ASSERT_EQ(items.size(), 2u);
+  EXPECT_EQ(items[1], 5);
+}
+
+TEST_F(MulticastRingBufferTest, DestroysElementsOnReuseAndDestruction) {
+  auto shared = std::make_shared<int>(0);
+  {
+    MulticastRingBuffer<std::shared_ptr<int>> buffer(2);
+    auto& consumer = buffer.AddConsumer();
+    for (int i = 0; i < 5; ++i) {
+      ASSERT_TRUE(buffer.Push(shared));
+      consumer.Release(consumer.Peek().size());
+    }
+    // released elements stay in their slots until the producer reuses them
+    EXPECT_EQ(shared.use_count(), 3);
+  }
+  EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST_F(MulticastRingBufferTest, ThrowingConstructorOnReusedSlot) {
+  int live = 0;
+  {
+    MulticastRingBuffer<Counted> buffer(2);
+    auto& consumer = buffer.AddConsumer();
+    for (int i = 0; i < 2; ++i) {
+      ASSERT_TRUE(buffer.Emplace(live, false));
+      consumer.Release(consumer.Peek().size());
+    }
+
+    // the element of the previous lap is gone, nothing takes its place
+    EXPECT_THROW(buffer.Emplace(live, true), std::runtime_error);
+    EXPECT_EQ(live, 1);
+    EXPECT_TRUE(consumer.Peek().empty());
+    EXPECT_THROW(buffer.Emplace(live, true), std::runtime_error);
+    EXPECT_EQ(live, 1);
+
+    ASSERT_TRUE(buffer.Emplace(live, false));
+    EXPECT_EQ(live, 2);
+    EXPECT_EQ(consumer.Peek().size(), 1u);
+    consumer.Release(1);
+    EXPECT_THROW(buffer.Emplace(live, true), std::runtime_error);
+    EXPECT_EQ(live, 1);
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST_F(MulticastRingBufferTest, Pipeline) {
+  const size_t num_items = 50000;
+  MulticastRingBuffer<size_t> buffer(64);
+  auto& stageA = buffer.AddConsumer();
+  auto& analytics = buffer.AddConsumer();
+  auto& stageB = buffer.AddConsumer({&stageA});
+
+  std::vector<std::atomic<bool>> processedByA(num_items);
+  std::atomic<bool> orderViolated{false};
+
+  auto run = [&](MulticastRingBuffer<size_t>::Consumer& consumer, auto onElement) {
+    return std::thread([&consumer, onElement]() {
+      size_t expected = 0;
+      while (expected < num_items) {
+        auto items = consumer.Peek(16);
+        for (size_t val : items) {
+          onElement(val, expected++);
+        }
+        consumer.Release(items.size());
+        if (items.empty()) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  };
+
+  std::vector<size_t> seenByAnalytics;
+  std::vector<std::thread> consumers;
+  consumers.push_back(run(stageA, [&](size_t val, size_t expected) {
+    orderViolated = orderViolated || val != expected;
+    processedByA[val].store(true);
+  }));
+  consumers.push_back(
+    run(analytics, [&](size_t val, size_t) { seenByAnalytics.push_back(val); }));
+  consumers.push_back(run(stageB, [&](size_t val, size_t expected) {
+    orderViolated = orderViolated || val != expected || !processedByA[val].load();
+  }));
+
+  for (size_t i = 0; i < num_items; ++i) {
+    while (!buffer.Push(i)) {
+      std::this_thread::yield();
+    }
+  }
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+
+  EXPECT_FALSE(orderViolated.load());
+  ASSERT_EQ(seenByAnalytics.size(), num_items);
+  for (size_t i = 0; i < num_items; ++i) {
+    EXPECT_EQ(seenByAnalytics[i], i);
+  }
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <common/containers/overwriting_ring_buffer.hpp>
+#include <cstdint>
+#include <thread>
+
+using common::containers::OverwritingRingBuffer;
+
+class OverwritingRingBufferTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+  }
+
+  void TearDown() override {
+  }
+};
+
+TEST_F(OverwritingRingBufferTest, BasicPushPop) {
+  OverwritingRingBuffer<int> buffer(8);
+
+  buffer.Push(42);
+  auto val = buffer.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(val.value(), 42);
+  EXPECT_EQ(buffer.Skipped(), 0u);
+}
+
+TEST_F(OverwritingRingBufferTest, EmptyPop) {
+  OverwritingRingBuffer<int> buffer(8);
+
+  EXPECT_FALSE(buffer.Pop().has_value());
+  buffer.Push(1);
+  buffer.Pop();
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(OverwritingRingBufferTest, FillWithoutOverrun) {
+  OverwritingRingBuffer<int> buffer(6);
+  ASSERT_EQ(buffer.Capacity(), 8u);
+
+  for (int round = 0; round < 5; ++round) {
+    for (int i = 0; i < 8; ++i) {
+      buffer.Push(round * 8 + i);
+    }
+    for (int i = 0; i < 8; ++i) {
+      EXPECT_EQ(buffer.Pop().value(), round * 8 + i);
+    }
+    EXPECT_FALSE(buffer.Pop().has_value());
+  }
+  EXPECT_EQ(buffer.Skipped(), 0u);
+}
+
+TEST_F(OverwritingRingBufferTest, OverwritesOldest) {
+  OverwritingRingBuffer<int> buffer(4);
+
+  for (int i = 0; i < 10; ++i) {
+    buffer.Push(i);
+  }
+  // only the last lap survives
+  for (int i = 6; i < 10; ++i) {
+    EXPECT_EQ(buffer.Pop().value(), i);
+  }
+  EXPECT_FALSE(buffer.Pop().has_value());
+  EXPECT_EQ(buffer.Skipped(), 6u);
+}
+
+TEST_F(OverwritingRingBufferTest, OverrunAfterPartialRead) {
+  OverwritingRingBuffer<int> buffer(4);
+
+  for (int i = 0; i < 4; ++i) {
+    buffer.Push(i);
+  }
+  EXPECT_EQ(buffer.Pop().value(), 0);
+  EXPECT_EQ(buffer.Pop().value(), 1);
+
+  // laps the consumer, which was at 2
+  for (int i = 4; i < 11; ++i) {
+    buffer.Push(i);
+  }
+  EXPECT_EQ(buffer.Pop().value(), 7);
+  EXPECT_EQ(buffer.Skipped(), 5u);
+
+  buffer.Push(11);
+  for (int i = 8; i < 12; ++i) {
+    EXPECT_EQ(buffer.Pop().value(), i);
+  }
+  EXPECT_EQ(buffer.Skipped(), 5u);
+}
+
+TEST_F(OverwritingRingBufferTest, MultiWordElements) {
+  // 20 bytes, not a whole number of words
+  struct Snapshot {
+    uint32_t id;
+    float bid;
+    float ask;
+    std::array<char, 5> venue;
+  };
+
+  OverwritingRingBuffer<Snapshot> buffer(2);
+  for (uint32_t i = 0; i < 5; ++i) {
+    buffer.Push(Snapshot{i, i + 0.25f, i + 0.5f, {'X', 'N', 'A', 'S', static_cast<char>('0' + i)}});
+  }
+  for (uint32_t i = 3; i < 5; ++i) {
+    auto snapshot = buffer.Pop().value();
+    EXPECT_EQ(snapshot.id, i);
+    EXPECT_EQ(snapshot.bid, i + 0.25f);
+    EXPECT_EQ(snapshot.ask, i + 0.5f);
+    EXPECT_EQ(snapshot.venue[4], static_cast<char>('0' + i));
+  }
+  EXPECT_EQ(buffer.Skipped(), 3u);
+}
+
+TEST_F(OverwritingRingBufferTest, ConcurrentOverwrite) {
+  const uint64_t num_items = 500000;
+  OverwritingRingBuffer<std::array<uint64_t, 4>> buffer(16);
+  std::atomic<bool> done{false};
+
+  std::thread producer([&]() {
+    for (uint64_t i = 0; i < num_items; ++i) {
+      buffer.Push({i, i * 3, i * 5, i * 7});
+    }
+    done.store(true);
+  });
+
+  uint64_t consumed = 0;
+  std::thread consumer([&]() {
+    auto check = [&](const std::array<uint64_t, 4>& val) {
+      // every position is either consumed or skipped, in order, and never torn
+      ASSERT_EQ(val[0], consumed + buffer.Skipped());
+      ASSERT_EQ(val[1], val[0] * 3);
+      ASSERT_EQ(val[2], val[0] * 5);
+      ASSERT_EQ(val[3], val[0] * 7);
+      ++consumed;
+    };
+    while (!done.load()) {
+      if (auto val = buffer.Pop()) {
+        check(*val);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    while (auto val = buffer.Pop()) {
+      check(*val);
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  EXPECT_EQ(consumed + buffer.Skipped(), num_items);
+  EXPECT_GE(consumed, buffer.Capacity());
+}
@@ -1,12 +1,21 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <common/containers/ring_buffer.hpp>
+#include <memory>
 #include <numeric>
+#include <string>
 #include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+using common::containers::CapacityMode;
 using common::containers::RingBuffer;
+using common::containers::StorageOptions;
+using os::memory::PageBacking;
 
 class RingBufferTest : public ::testing::Test {
 protected:
@@ -243,3 +252,310 @@ TEST_F(RingBufferTest, StressTestWithDelays) {
     EXPECT_EQ(consumed[i], i);
   }
 }
+
+TEST_F(RingBufferTest, PowerOfTwoUsesEverySlot) {
+  const size_t capacity = 8;
+  RingBuffer<int, CapacityMode::PowerOfTwo> buffer(capacity);
+  EXPECT_EQ(buffer.Capacity(), capacity);
+
+  for (size_t i = 0; i < capacity; ++i) {
+    EXPECT_TRUE(buffer.Push(static_cast<int>(i)));
+  }
+  EXPECT_FALSE(buffer.Push(999));
+
+  for (size_t i = 0; i < capacity; ++i) {
+    auto val = buffer.Pop();
+    ASSERT_TRUE(val.has_value());
+    EXPECT_EQ(val.value(), static_cast<int>(i));
+  }
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(RingBufferTest, PowerOfTwoRoundsCapacityUp) {
+  RingBuffer<int, CapacityMode::PowerOfTwo> buffer(10);
+  EXPECT_EQ(buffer.Capacity(), 16u);
+
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_TRUE(buffer.Push(i));
+  }
+  EXPECT_FALSE(buffer.Push(999));
+}
+
+TEST_F(RingBufferTest, PowerOfTwoWrapAround) {
+  RingBuffer<int, CapacityMode::PowerOfTwo> buffer(4);
+
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_TRUE(buffer.Push(round * 10 + i));
+    }
+    for (int i = 0; i < 3; ++i) {
+      auto val = buffer.Pop();
+      ASSERT_TRUE(val.has_value());
+      EXPECT_EQ(val.value(), round * 10 + i);
+    }
+  }
+}
+
+TEST_F(RingBufferTest, PowerOfTwoHighContentionSPSC) {
+  const size_t num_items = 50000;
+  const size_t capacity = 16;
+  RingBuffer<size_t, CapacityMode::PowerOfTwo> buffer(capacity);
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      while (!buffer.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::thread consumer([&]() {
+    while (consumed.size() < num_items) {
+      auto val = buffer.Pop();
+      if (val.has_value()) {
+        consumed.push_back(val.value());
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  ASSERT_EQ(consumed.size(), num_items);
+  for (size_t i = 0; i < num_items; ++i) {
+    EXPECT_EQ(consumed[i], i);
+  }
+}
+
+namespace {
+
+// Counts live instances to check that the buffer constructs and destroys elements in pairs
+struct Tracked {
+  inline static int alive = 0;
+
+  explicit Tracked(int v) : value(v) {
+    ++alive;
+  }
+  Tracked(Tracked&& other) : value(other.value) {
+    ++alive;
+  }
+  ~Tracked() {
+    --alive;
+  }
+
+  int value;
+};
+
+}  // namespace
+
+TEST_F(RingBufferTest, ElementLifetime) {
+  {
+    RingBuffer<Tracked> buffer(8);
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_TRUE(buffer.Push(Tracked(i)));
+    }
+    EXPECT_EQ(Tracked::alive, 5);
+
+    EXPECT_EQ(buffer.Pop()->value, 0);
+    EXPECT_EQ(Tracked::alive, 4);
+  }
+  // remaining elements are destroyed with the buffer
+  EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST_F(RingBufferTest, Emplace) {
+  RingBuffer<std::pair<int, std::string>> buffer(4);
+
+  EXPECT_TRUE(buffer.Emplace(1, "one"));
+  EXPECT_TRUE(buffer.Emplace(std::piecewise_construct, std::forward_as_tuple(2),
+                             std::forward_as_tuple(3, 'x')));
+
+  auto val = buffer.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(val->first, 1);
+  EXPECT_EQ(val->second, "one");
+  EXPECT_EQ(buffer.Pop()->second, "xxx");
+}
+
+TEST_F(RingBufferTest, EmplaceFailsWithoutConstructingWhenFull) {
+  RingBuffer<Tracked> buffer(3);
+  EXPECT_TRUE(buffer.Emplace(1));
+  EXPECT_TRUE(buffer.Emplace(2));
+  EXPECT_EQ(Tracked::alive, 2);
+
+  EXPECT_FALSE(buffer.Emplace(3));
+  EXPECT_EQ(Tracked::alive, 2);
+}
+
+TEST_F(RingBufferTest, TryEmplaceInvokesFactoryOnlyWhenThereIsRoom) {
+  RingBuffer<Tracked> buffer(2);
+  int calls = 0;
+  auto factory = [&calls] {
+    return Tracked(++calls);
+  };
+
+  EXPECT_TRUE(buffer.TryEmplace(factory));
+  EXPECT_FALSE(buffer.TryEmplace(factory));
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(buffer.Pop()->value, 1);
+}
+
+TEST_F(RingBufferTest, WaitPopBlocksUntilWaitPush) {
+  RingBuffer<int> buffer(4);
+  std::atomic<bool> popped{false};
+
+  std::thread consumer([&]() {
+    EXPECT_EQ(buffer.WaitPop(/* spinBudget */ 0), 42);
+    popped.store(true);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(popped.load());
+  buffer.WaitPush(42);
+  consumer.join();
+  EXPECT_TRUE(popped.load());
+}
+
+TEST_F(RingBufferTest, WaitForTimesOut) {
+  RingBuffer<std::unique_ptr<int>> buffer(2);
+
+  EXPECT_FALSE(buffer.WaitPopFor(std::chrono::milliseconds(5)).has_value());
+
+  // a single usable slot
+  auto first = std::make_unique<int>(1);
+  EXPECT_TRUE(buffer.WaitPushFor(std::move(first), std::chrono::milliseconds(5)));
+
+  auto second = std::make_unique<int>(2);
+  EXPECT_FALSE(buffer.WaitPushFor(std::move(second), std::chrono::milliseconds(5)));
+  // not moved from on timeout
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(*second, 2);
+
+  auto val = buffer.WaitPopFor(std::chrono::milliseconds(5));
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(**val, 1);
+}
+
+TEST_F(RingBufferTest, BlockingSPSC) {
+  const size_t num_items = 20000;
+  RingBuffer<size_t> buffer(8);
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+
+  // a zero spin budget parks on every miss
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      buffer.WaitPush(i, /* spinBudget */ i % 2 == 0 ? 0 : 16);
+    }
+  });
+
+  std::thread consumer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      consumed.push_back(buffer.WaitPop(/* spinBudget */ i % 3 == 0 ? 0 : 16));
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  ASSERT_EQ(consumed.size(), num_items);
+  for (size_t i = 0; i < num_items; ++i) {
+    EXPECT_EQ(consumed[i], i);
+  }
+}
+
+TEST_F(RingBufferTest, ConsumeAll) {
+  RingBuffer<int> buffer(8);
+
+  EXPECT_EQ(buffer.ConsumeAll([](int&) { FAIL(); }), 0u);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(buffer.Push(i));
+  }
+
+  std::vector<int> consumed;
+  EXPECT_EQ(buffer.ConsumeAll([&](int& val) { consumed.push_back(val); }), 5u);
+  EXPECT_EQ(consumed, (std::vector<int>{0, 1, 2, 3, 4}));
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(RingBufferTest, ConsumeUpToAcrossWrapPoint) {
+  RingBuffer<std::unique_ptr<int>, CapacityMode::PowerOfTwo> buffer(4);
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(buffer.Push(std::make_unique<int>(i)));
+  }
+  ASSERT_EQ(*buffer.Pop().value(), 0);
+  for (int i = 3; i < 5; ++i) {
+    ASSERT_TRUE(buffer.Push(std::make_unique<int>(i)));
+  }
+
+  // elements 1..4 sit in slots 1..3 and 0, the callback may take ownership
+  std::vector<std::unique_ptr<int>> consumed;
+  auto take = [&](std::unique_ptr<int>& val) { consumed.push_back(std::move(val)); };
+  EXPECT_EQ(buffer.ConsumeUpTo(3, take), 3u);
+  EXPECT_EQ(buffer.ConsumeUpTo(3, take), 1u);
+  ASSERT_EQ(consumed.size(), 4u);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(*consumed[i], i + 1);
+  }
+}
+
+TEST_F(RingBufferTest, ConsumeSPSC) {
+  const size_t num_items = 200000;
+  RingBuffer<size_t> buffer(64);
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      while (!buffer.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+  std::thread consumer([&]() {
+    while (consumed.size() < num_items) {
+      if (buffer.ConsumeUpTo(16, [&](size_t val) { consumed.push_back(val); }) == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  for (size_t i = 0; i < num_items; ++i) {
+    ASSERT_EQ(consumed[i], i);
+  }
+}
+
+TEST_F(RingBufferTest, HugePageStorage) {
+  // which kind of page backs the slots depends on the system, every kind must work
+  RingBuffer<size_t, CapacityMode::PowerOfTwo> buffer(
+    1 << 16, StorageOptions{.hugePages = true, .prefault = true});
+
+  for (size_t round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < buffer.Capacity(); ++i) {
+      ASSERT_TRUE(buffer.Push(round + i));
+    }
+    EXPECT_FALSE(buffer.Push(0));
+    for (size_t i = 0; i < buffer.Capacity(); ++i) {
+      ASSERT_EQ(buffer.Pop().value(), round + i);
+    }
+  }
+}
+
+TEST_F(RingBufferTest, DefaultStorageIsRegularPages) {
+  RingBuffer<int> buffer(16, StorageOptions{.prefault = true});
+
+  EXPECT_EQ(buffer.Backing(), PageBacking::Regular);
+  EXPECT_TRUE(buffer.Push(1));
+  EXPECT_EQ(buffer.Pop().value(), 1);
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <common/containers/shm_ring_buffer.hpp>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using common::containers::ShmRingBuffer;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct Quote {
+  uint64_t id;
+  double bid;
+  double ask;
+};
+
+}  // namespace
+
+class ShmRingBufferTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+  }
+
+  void TearDown() override {
+  }
+};
+
+TEST_F(ShmRingBufferTest, BasicPushPop) {
+  auto buffer = ShmRingBuffer<int>::Create(8);
+
+  EXPECT_TRUE(buffer.Push(42));
+  auto val = buffer.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(val.value(), 42);
+  EXPECT_FALSE(buffer.Pop().has_value());
+}
+
+TEST_F(ShmRingBufferTest, FillBuffer) {
+  auto buffer = ShmRingBuffer<int>::Create(10);
+  ASSERT_EQ(buffer.Capacity(), 16u);
+
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_TRUE(buffer.Push(i));
+  }
+  EXPECT_FALSE(buffer.Push(16));
+
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_EQ(buffer.Pop().value(), i);
+  }
+}
+
+TEST_F(ShmRingBufferTest, OpenSharesRingThroughSecondMapping) {
+  auto producer = ShmRingBuffer<Quote>::Create(4);
+  auto consumer = ShmRingBuffer<Quote>::Open(producer.Fd());
+
+  // the second mapping lives at another address, only offsets are shared
+  ASSERT_TRUE(producer.Push({1, 99.5, 100.5}));
+  auto items = consumer.Peek();
+  ASSERT_EQ(items.size(), 1u);
+  EXPECT_EQ(items[0].id, 1u);
+  EXPECT_EQ(items[0].ask, 100.5);
+  consumer.Release(1);
+
+  for (uint64_t i = 0; i < 4; ++i) {
+    EXPECT_TRUE(producer.Push({i, 0, 0}));
+  }
+  EXPECT_FALSE(producer.Push({4, 0, 0}));
+  EXPECT_EQ(consumer.Pop()->id, 0u);
+  EXPECT_TRUE(producer.Push({4, 0, 0}));
+}
+
+TEST_F(ShmRingBufferTest, OpenAfterTraffic) {
+  auto producer = ShmRingBuffer<int>::Create(4);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(producer.Push(i));
+    auto consumer = ShmRingBuffer<int>::Open(producer.Fd());
+    ASSERT_EQ(consumer.Pop().value(), i);
+  }
+
+  // both indices are at 5, a fresh consumer must see an empty ring
+  auto consumer = ShmRingBuffer<int>::Open(producer.Fd());
+  EXPECT_FALSE(consumer.Pop().has_value());
+  int out[4];
+  EXPECT_EQ(consumer.PopBulk(out, 4), 0u);
+  EXPECT_TRUE(consumer.Peek(4).empty());
+
+  // and a fresh producer must still see the free slots
+  auto other = ShmRingBuffer<int>::Open(producer.Fd());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(other.Push(i));
+  }
+  EXPECT_FALSE(other.Push(4));
+  EXPECT_EQ(consumer.PopBulk(out, 4), 4u);
+  EXPECT_EQ(out[3], 3);
+}
+
+TEST_F(ShmRingBufferTest, BulkWrapsAround) {
+  auto producer = ShmRingBuffer<int>::Create(8);
+  auto consumer = ShmRingBuffer<int>::Open(producer.Fd());
+
+  std::vector<int> out;
+  int next = 0;
+  for (int round = 0; round < 5; ++round) {
+    std::array<int, 5> items;
+    std::iota(items.begin(), items.end(), next);
+    ASSERT_EQ(producer.PushBulk(std::span<const int>(items)), 5u);
+    next += 5;
+    ASSERT_EQ(consumer.PopBulk(std::back_inserter(out), 8), 5u);
+  }
+
+  std::vector<int> expected(25);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(out, expected);
+}
+
+TEST_F(ShmRingBufferTest, OpenRejectsDifferentElementType) {
+  auto buffer = ShmRingBuffer<uint64_t>::Create(8);
+
+  EXPECT_THROW(ShmRingBuffer<uint32_t>::Open(buffer.Fd()), std::runtime_error);
+  EXPECT_THROW(ShmRingBuffer<Quote>::Open(buffer.Fd()), std::runtime_error);
+}
+
+TEST_F(ShmRingBufferTest, OpenRejectsUninitializedMapping) {
+  int fd = ::memfd_create("not_a_ring", MFD_CLOEXEC);
+  ASSERT_GE(fd, 0);
+
+  EXPECT_THROW(ShmRingBuffer<int>::Open(fd), std::runtime_error);
+  ASSERT_EQ(::ftruncate(fd, 4096), 0);
+  EXPECT_THROW(ShmRingBuffer<int>::Open(fd), std::runtime_error);
+  ::close(fd);
+}
+
+TEST_F(ShmRingBufferTest, NamedRing) {
+  const std::string name = "/shm_ring_buffer_test_" + std::to_string(::getpid());
+  {
+    auto producer = ShmRingBuffer<int>::CreateNamed(name.c_str(), 8);
+    EXPECT_THROW(ShmRingBuffer<int>::CreateNamed(name.c_str(), 8), std::system_error);
+
+    auto consumer = ShmRingBuffer<int>::OpenNamed(name.c_str());
+    EXPECT_TRUE(producer.Push(7));
+    EXPECT_EQ(consumer.Pop().value(), 7);
+  }
+  ShmRingBuffer<int>::Unlink(name.c_str());
+  EXPECT_THROW(ShmRingBuffer<int>::OpenNamed(name.c_str()), std::system_error);
+}
+
+TEST_F(ShmRingBufferTest, FailedCreateNamedLeavesNoObject) {
+  const std::string name = "/shm_ring_buffer_test_" + std::to_string(::getpid());
+  // far beyond the address space, so mmap fails
+  EXPECT_THROW(ShmRingBuffer<int>::CreateNamed(name.c_str(), size_t{1} << 56), std::system_error);
+  EXPECT_THROW(ShmRingBuffer<int>::OpenNamed(name.c_str()), std::system_error);
+
+  auto buffer = ShmRingBuffer<int>::CreateNamed(name.c_str(), 8);
+  ShmRingBuffer<int>::Unlink(name.c_str());
+  EXPECT_TRUE(buffer.Push(1));
+}
+
+TEST_F(ShmRingBufferTest, CreateWithMemfdName) {
+  auto buffer = ShmRingBuffer<int>::Create("quotes", 8);
+  EXPECT_EQ(buffer.Capacity(), 8u);
+  EXPECT_TRUE(buffer.Push(1));
+  EXPECT_EQ(buffer.Pop().value(), 1);
+}
+
+TEST_F(ShmRingBufferTest, WaitPopForTimesOut) {
+  auto buffer = ShmRingBuffer<int>::Create(4);
+
+  EXPECT_FALSE(buffer.WaitPopFor(1ms).has_value());
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(buffer.Push(i));
+  }
+  EXPECT_FALSE(buffer.WaitPushFor(4, 1ms));
+}
+
+TEST_F(ShmRingBufferTest, CrossProcess) {
+  constexpr uint64_t kCount = 100'000;
+  // a small ring and no spinning make both processes park on the shared futexes
+  auto consumer = ShmRingBuffer<Quote>::Create(8);
+
+  pid_t pid = ::fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    auto producer = ShmRingBuffer<Quote>::Open(consumer.Fd());
+    for (uint64_t i = 0; i < kCount; ++i) {
+      producer.WaitPush({i, 1.0, 2.0}, /* spinBudget */ 0);
+    }
+    ::_exit(0);
+  }
+
+  uint64_t sum = 0;
+  bool ordered = true;
+  for (uint64_t i = 0; i < kCount; ++i) {
+    auto quote = consumer.WaitPop(/* spinBudget */ 0);
+    ordered &= quote.id == i;
+    sum += quote.id;
+  }
+
+  int status = 0;
+  ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(sum, kCount * (kCount - 1) / 2);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <common/containers/triple_buffer.hpp>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using common::containers::TripleBuffer;
+
+class TripleBufferTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+  }
+
+  void TearDown() override {
+  }
+};
+
+TEST_F(TripleBufferTest, InitialValue) {
+  TripleBuffer<std::string> buffer("empty");
+
+  EXPECT_FALSE(buffer.Update());
+  EXPECT_EQ(buffer.Front(), "empty");
+  EXPECT_EQ(buffer.Back(), "empty");
+}
+
+TEST_F(TripleBufferTest, WriteThenRead) {
+  TripleBuffer<int> buffer;
+
+  buffer.Write(42);
+  EXPECT_EQ(buffer.Read(), 42);
+  // nothing new
+  EXPECT_FALSE(buffer.Update());
+  EXPECT_EQ(buffer.Front(), 42);
+}
+
+TEST_F(TripleBufferTest, ReaderOnlySeesLatest) {
+  TripleBuffer<int> buffer;
+
+  for (int i = 1; i <= 5; ++i) {
+    buffer.Write(i);
+  }
+  EXPECT_TRUE(buffer.Update());
+  EXPECT_EQ(buffer.Front(), 5);
+  EXPECT_FALSE(buffer.Update());
+}
+
+TEST_F(TripleBufferTest, FrontStableUntilUpdate) {
+  TripleBuffer<int> buffer;
+
+  buffer.Write(1);
+  ASSERT_TRUE(buffer.Update());
+  const int* front = &buffer.Front();
+
+  // however much the writer publishes, it never writes into the reader's copy
+  for (int i = 2; i < 100; ++i) {
+    buffer.Back() = i;
+    EXPECT_NE(&buffer.Back(), front);
+    buffer.Publish();
+    EXPECT_EQ(buffer.Front(), 1);
+  }
+  EXPECT_EQ(buffer.Read(), 99);
+}
+
+TEST_F(TripleBufferTest, FillBackInPlace) {
+  TripleBuffer<std::vector<int>> buffer(4, 0);
+
+  for (int round = 1; round <= 3; ++round) {
+    auto& back = buffer.Back();
+    // the back copy is stale, not the last published value
+    ASSERT_EQ(back.size(), 4u);
+    std::fill(back.begin(), back.end(), round);
+    buffer.Publish();
+    EXPECT_EQ(buffer.Read(), std::vector<int>(4, round));
+  }
+}
+
+TEST_F(TripleBufferTest, ConcurrentSnapshotsAreComplete) {
+  // 2 KB, spans many cache lines
+  using Snapshot = std::array<uint64_t, 256>;
+  const uint64_t num_snapshots = 100000;
+  TripleBuffer<Snapshot> buffer;
+  std::atomic<bool> done{false};
+
+  std::thread writer([&]() {
+    for (uint64_t seq = 1; seq <= num_snapshots; ++seq) {
+      buffer.Back().fill(seq);
+      buffer.Publish();
+    }
+    done.store(true);
+  });
+
+  uint64_t last = 0;
+  uint64_t updates = 0;
+  std::thread reader([&]() {
+    while (true) {
+      // checked before updating, so the last snapshot is taken after the writer stops
+      const bool finished = done.load();
+      if (buffer.Update()) {
+        const auto& snapshot = buffer.Front();
+        // never torn, never older than what was already seen
+        ASSERT_GT(snapshot[0], last);
+        for (auto word : snapshot) {
+          ASSERT_EQ(word, snapshot[0]);
+        }
+        last = snapshot[0];
+        ++updates;
+      } else if (finished) {
+        break;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  writer.join();
+  reader.join();
+
+  EXPECT_EQ(last, num_snapshots);
+  EXPECT_GT(updates, 0u);
+}
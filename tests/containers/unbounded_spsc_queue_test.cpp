@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <common/containers/unbounded_spsc_queue.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using common::containers::UnboundedSPSCQueue;
+
+class UnboundedSPSCQueueTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+  }
+
+  void TearDown() override {
+  }
+};
+
+TEST_F(UnboundedSPSCQueueTest, BasicPushPop) {
+  UnboundedSPSCQueue<int> queue;
+
+  queue.Push(42);
+  auto val = queue.Pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(val.value(), 42);
+}
+
+TEST_F(UnboundedSPSCQueueTest, EmptyPop) {
+  UnboundedSPSCQueue<int> queue;
+
+  EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST_F(UnboundedSPSCQueueTest, GrowsAcrossSegments) {
+  UnboundedSPSCQueue<int> queue(/* segmentSize */ 4, /* maxSpareSegments */ 4);
+
+  for (int i = 0; i < 100; ++i) {
+    queue.Push(i);
+  }
+  EXPECT_EQ(queue.Segments(), 25u);
+
+  for (int i = 0; i < 100; ++i) {
+    auto val = queue.Pop();
+    ASSERT_TRUE(val.has_value());
+    EXPECT_EQ(val.value(), i);
+  }
+  EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST_F(UnboundedSPSCQueueTest, ShrinksAfterBurst) {
+  UnboundedSPSCQueue<int> queue(/* segmentSize */ 4, /* maxSpareSegments */ 2);
+
+  for (int i = 0; i < 100; ++i) {
+    queue.Push(i);
+  }
+  while (queue.Pop()) {
+  }
+  // the head segment plus the spare ones, everything else was freed
+  EXPECT_EQ(queue.Segments(), 3u);
+}
+
+TEST_F(UnboundedSPSCQueueTest, SteadyStateReusesSegments) {
+  UnboundedSPSCQueue<int> queue(/* segmentSize */ 4, /* maxSpareSegments */ 2);
+
+  for (int round = 0; round < 1000; ++round) {
+    for (int i = 0; i < 10; ++i) {
+      queue.Push(round * 10 + i);
+    }
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_EQ(queue.Pop().value(), round * 10 + i);
+    }
+    EXPECT_LE(queue.Segments(), 4u);
+  }
+}
+
+TEST_F(UnboundedSPSCQueueTest, PopAfterSegmentLinkedButNotWritten) {
+  UnboundedSPSCQueue<int> queue(/* segmentSize */ 2);
+
+  queue.Push(1);
+  queue.Push(2);
+  EXPECT_EQ(queue.Pop().value(), 1);
+  EXPECT_EQ(queue.Pop().value(), 2);
+  EXPECT_FALSE(queue.Pop().has_value());
+
+  queue.Emplace(3);
+  EXPECT_EQ(queue.Pop().value(), 3);
+  EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST_F(UnboundedSPSCQueueTest, ZeroSegmentSizeHoldsOneElementPerSegment) {
+  UnboundedSPSCQueue<int> queue(/* segmentSize */ 0);
+
+  for (int i = 0; i < 3; ++i) {
+    queue.Push(i);
+  }
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(queue.Pop().value(), i);
+  }
+  EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST_F(UnboundedSPSCQueueTest, MoveOnly) {
+  UnboundedSPSCQueue<std::unique_ptr<std::string>> queue(/* segmentSize */ 2);
+
+  for (int i = 0; i < 5; ++i) {
+    queue.Emplace(std::make_unique<std::string>(std::to_string(i)));
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(*queue.Pop().value(), std::to_string(i));
+  }
+}
+
+TEST_F(UnboundedSPSCQueueTest, ElementLifetime) {
+  auto tracked = std::make_shared<int>(0);
+  {
+    UnboundedSPSCQueue<std::shared_ptr<int>> queue(/* segmentSize */ 4);
+    for (int i = 0; i < 10; ++i) {
+      queue.Push(tracked);
+    }
+    queue.Pop();
+    queue.Pop();
+    EXPECT_EQ(tracked.use_count(), 9);
+  }
+  EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST_F(UnboundedSPSCQueueTest, HighContentionSPSC) {
+  const size_t num_items = 200000;
+  UnboundedSPSCQueue<size_t> queue(/* segmentSize */ 64, /* maxSpareSegments */ 2);
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < num_items; ++i) {
+      queue.Push(i);
+    }
+  });
+
+  std::vector<size_t> consumed;
+  consumed.reserve(num_items);
+  std::thread consumer([&]() {
+    while (consumed.size() < num_items) {
+      if (auto val = queue.Pop()) {
+        consumed.push_back(*val);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  for (size_t i = 0; i < num_items; ++i) {
+    ASSERT_EQ(consumed[i], i);
+  }
+  EXPECT_FALSE(queue.Pop().has_value());
+}